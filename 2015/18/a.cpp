@@ -40,9 +40,7 @@ int main() {
         matrix = std::move(next);
     }
 
-    int answer = std::ranges::count_if(box, [&](const Coord &u) {
-        return matrix[u.i][u.j] == '#';
-    });
+    long long answer = Count<2>(matrix, '#');
     std::cout << answer << std::endl;
     return 0;
 }
\ No newline at end of file
@@ -4,25 +4,18 @@
 #include <utility>
 #include <vector>
 
+#include "collections.h"
 #include "parse.h"
 
 int main() {
     std::vector<std::pair<long long, long long>> ranges;
     for (const std::string& line : Split(Trim(GetContents("input.txt")), "\n")) {
         auto [l, r] = SplitN(line, "-");
-        ranges.emplace_back(std::stoll(l), std::stoll(r));
+        ranges.emplace_back(std::stoll(l), std::stoll(r) + 1);
     }
-    
-    std::ranges::sort(ranges);
-    long long i = 0;
-    long long answer = 0;
-    for (const std::pair<long long, long long>& range : ranges) {
-        if (i < range.first) {
-            answer += range.first - i;
-        }
-        i = std::max(i, range.second + 1);
-    }
-    answer += (1ll << 32) - i;
+
+    IntervalSet<long long> blocked(ranges);
+    long long answer = blocked.Complement(0, 1ll << 32).TotalLength();
     std::cout << answer << std::endl;
     return 0;
 }
\ No newline at end of file
@@ -43,9 +43,7 @@ int main() {
         }
     }
 
-    int answer = std::ranges::count_if(box, [&](Coord u) {
-        return matrix[u.i][u.j] == '#';
-    });
+    long long answer = Count<2>(matrix, '#');
     std::cout << answer << std::endl;
     return 0;
 }
\ No newline at end of file
@@ -1,6 +1,5 @@
+#include <cstdint>
 #include <iostream>
-#include <string>
-#include <vector>
 
 #include "collections.h"
 #include "graph_search.h"
@@ -8,13 +7,8 @@
 #include "parse.h"
 
 int main() {
-    std::vector<std::string> input = Split(Trim(GetContents("input.txt")), "\n");
-    Box box = Sizes<2>(input);
-
-    NestedVector<2, int> energy = ConstVector(0, box.size_i, box.size_j);
-    for (Coord c : box) {
-        energy[c.i][c.j] = input[c.i][c.j] - '0';
-    }
+    Grid<uint8_t> energy = ReadGrid("input.txt").Digits();
+    Box box = energy.Bounds();
 
     int step = 0;
     for (;; step++) {
@@ -40,30 +40,31 @@ Pair ParsePair(const std::string& s) {
 }
 
 int main() {
-    std::unordered_map<Coord, char> map;
     std::vector<Pair> pairs;
     for (const std::string& line : Split(Trim(GetContents("input.txt")), "\n")) {
-        Pair pair = ParsePair(line);
-        pairs.push_back(pair);
-        map[pair.sensor] = 'S';
-        map[pair.beacon] = 'B';
+        pairs.push_back(ParsePair(line));
     }
 
-    int answer = 0;
+    // Positions in the row that are within reach of some sensor.
+    IntervalSet<int> covered;
     for (const Pair& pair : pairs) {
         int radius = (pair.beacon - pair.sensor).Manhattan();
         int left = radius - abs(pair.sensor.i - kI);
-        if (left < 0) {
-            continue;
+        if (left >= 0) {
+            covered.Insert(pair.sensor.j - left, pair.sensor.j + left + 1);
         }
+    }
 
-        for (Coord pos : PathCC({kI, pair.sensor.j - left}, {kI, pair.sensor.j + left})) {
-            if (!map.contains(pos)) {
-                answer++;
-                map[pos] = '#';
+    // Minus the sensors and beacons themselves.
+    std::unordered_set<Coord> occupied;
+    for (const Pair& pair : pairs) {
+        for (Coord c : {pair.sensor, pair.beacon}) {
+            if (c.i == kI && covered.Contains(c.j)) {
+                occupied.insert(c);
             }
         }
     }
+    int answer = covered.TotalLength() - occupied.size();
 
     std::cout << answer << std::endl;
     return 0;
@@ -20,6 +20,7 @@
 #include "numbers.h"
 #include "order.h"
 #include "parse.h"
+#include "profiler.h"
 
 // The solution visits 241'733'645 of these states. There was disk I/O.
 // Even freeing the memory after printing the answer took several minutes.
@@ -58,20 +59,22 @@ int main() {
     std::unordered_map<std::string, std::vector<std::string>> moves;
     std::unordered_map<std::string, int> valve_indices;
 
-    for (const std::string& line : Split(Trim(GetContents("input.txt")), "\n")) {
-        // Valve EG has flow rate=21; tunnels lead to valves WZ, OF, ZP, QD
-        std::vector<std::string> words = Split(line, " ");
-        std::string valve = words[1];
-        rates[valve] = std::stoi(words[4].substr(words[4].find('=') + 1));
-        for (int i = 9; i < words.size(); i++) {
-            moves[valve].push_back(words[i].substr(0, words[i].find(',')));
-        }
-        moves[valve].push_back("open");
+    {
+        ScopedTimer timer("parse");
+        for (const std::string& line : Split(Trim(GetContents("input.txt")), "\n")) {
+            // Valve EG has flow rate=21; tunnels lead to valves WZ, OF, ZP, QD
+            std::vector<std::string> words = Split(line, " ");
+            std::string valve = words[1];
+            rates[valve] = std::stoi(words[4].substr(words[4].find('=') + 1));
+            for (int i = 9; i < words.size(); i++) {
+                moves[valve].push_back(words[i].substr(0, words[i].find(',')));
+            }
+            moves[valve].push_back("open");
 
-        if (rates[valve] > 0) {
-            int index = valve_indices.size();
-            valve_indices[valve] = index;
-            std::cout << valve << " -> " << index << std::endl;
+            if (rates[valve] > 0) {
+                int index = valve_indices.size();
+                valve_indices[valve] = index;
+            }
         }
     }
 
@@ -81,9 +84,6 @@ int main() {
             return mem[s];
         }
         if (s.time_left == 0) {
-            if (mem.size() % 1000000 == 0) {
-                std::cout << mem.size() << std::endl;
-            }
             return mem[s] = 0;
         }
 
@@ -116,12 +116,12 @@ int main() {
             }
         }
 
-        if (mem.size() % 1000000 == 0) {
-            std::cout << mem.size() << std::endl;
-        }
         return mem[s] = total + s.rate;
     };
 
+    // Freeing mem takes long too, so it's the difference between the total
+    // and this phase.
+    ScopedTimer timer("search");
     std::cout << best(best, {"AA", "AA", 0, 0, 26}) << std::endl;
     std::cout << mem.size() << std::endl;
     return 0;
@@ -73,8 +73,11 @@ int main() {
         assert(s.length() == 16);
     }
 
-    std::vector<long long> periods;
-    long long answer = 1;
+    // Every ghost eventually loops. Describe each loop by the time it starts,
+    // its length and the times within it when the ghost is at a final node.
+    // Ghosts could also meet at final nodes before all of them enter their
+    // loops, but the input is constructed so that they don't.
+    std::vector<std::tuple<long long, long long, std::vector<long long>>> cycles;
     for (State s : starts) {
         StateMap<int> number;
         number.Init(-1);
@@ -83,19 +86,20 @@ int main() {
             number[s] = t++;
             s = Next(s);
         }
-        int period = t - number[s];
+        int offset = number[s], period = t - offset;
 
-        answer *= (period / (int)seq.size());
+        std::vector<long long> hits;
+        for (int h = 0; h < period; h++) {
+            if (IsFinal(s)) {
+                hits.push_back(h);
+            }
+            s = Next(s);
+        }
+        cycles.emplace_back(offset, period, hits);
     }
-    answer *= (int)seq.size();
-    std::cout << answer << std::endl;
-
-    // Well, there's no reason this solution would work in general, but the
-    // input is clearly constructed artificially to make it easy. All periods
-    // have gcd == seq.size() with each other, and each period contains precisely
-    // one final state. To make things even simpler, that happens exactly at
-    // times that are == 0 (mod period), so we don't need to bother with the
-    // Chinese Remainder Theorem.
 
+    std::optional<long long> answer = CombineCycles(cycles);
+    assert(answer.has_value());
+    std::cout << *answer << std::endl;
     return 0;
 }
\ No newline at end of file
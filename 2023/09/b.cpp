@@ -15,26 +15,17 @@
 #include "order.h"
 #include "numbers.h"
 #include "parse.h"
+#include "sequence.h"
 
 int main() {
     std::vector<std::string> lines = Split(Trim(GetContents("input.txt")), "\n");
 
     long long answer = 0;
     for (const std::string& line : lines) {
-        std::vector<long long> xs = ParseVector<long long>(line);
-        long long y = 0;
-        int k = 1;
-        while(!xs.empty()) {
-            y += xs.front() * k;
-            k *= -1;
-            std::vector<long long> ds(xs.size() - 1);
-            for (int i = 0; i < ds.size(); i++) {
-                ds[i] = xs[i + 1] - xs[i];
-            }
-            xs = std::move(ds);
-        }
-        std::cout << y << std::endl;
-        answer += y;
+        std::optional<SequenceModel<long long>> model =
+            SequenceModel<long long>::FitPolynomial(ParseVector<long long>(line));
+        assert(model.has_value());
+        answer += model->At(-1);
     }
 
     std::cout << answer << std::endl;
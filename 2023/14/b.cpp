@@ -15,6 +15,7 @@
 #include "numbers.h"
 #include "order.h"
 #include "parse.h"
+#include "profiler.h"
 
 int GetLoad(const std::vector<std::string>& input) {
     int answer = 0;
@@ -70,27 +71,29 @@ std::string Cat(const std::vector<std::string>& ss) {
 }
 
 int main() {
-    std::vector<std::string> state = Split(Trim(GetContents("input.txt")), "\n");
+    std::vector<std::string> state;
+    {
+        ScopedTimer timer("parse");
+        state = Split(Trim(GetContents("input.txt")), "\n");
+    }
     std::vector<std::vector<std::string>> states;
 
     std::unordered_map<std::string, int> index;
     int from = 0, to = 0;
     for (int i = 0; i < 1000000000; i++) {
-        if (i % 1000000 == 0) {
-            std::cout << "Cycle " << i << std::endl;
-        }
         states.push_back(state);
 
-        std::string s = Cat(state);
-        auto it = index.find(s);
-        if (it == index.end()) {
-            index[s] = i;
-        } else {
-            from = it->second;
-            to = i;
-            break;
+        {
+            ScopedTimer timer("lookup");
+            auto [it, inserted] = index.emplace(Cat(state), i);
+            if (!inserted) {
+                from = it->second;
+                to = i;
+                break;
+            }
         }
 
+        ScopedTimer timer("cycle");
         state = Cycle(std::move(state));
     }
 
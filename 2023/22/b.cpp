@@ -20,6 +20,7 @@
 #include "numbers.h"
 #include "order.h"
 #include "parse.h"
+#include "parse_cache.h"
 
 struct Vect {
     int x, y, z;
@@ -63,11 +64,15 @@ std::optional<int> Weight(const Brick& u, const Brick& v) {
 }
 
 int main() {
-    std::vector<std::string> lines = Split(Trim(GetContents("input.txt")), "\n");
-    std::vector<Brick> bricks;
-    for (const std::string& s : lines) {
-        bricks.push_back(ParseBrick(s));
-    }
+    // Both parts share the parsed bricks in input.txt.bricks.cache.
+    std::vector<Brick> bricks = CachedParse<std::vector<Brick>>(
+        "input.txt", "bricks", 1, [](const std::string& contents) {
+            std::vector<Brick> result;
+            for (const std::string& s : Split(Trim(contents), "\n")) {
+                result.push_back(ParseBrick(s));
+            }
+            return result;
+        });
 
     // Determine how far each brick will fall.
     std::unordered_map<Brick, int> fall = Dijkstra<Brick, int>(
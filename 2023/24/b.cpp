@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iostream>
 #include <limits>
@@ -12,6 +13,8 @@
 #include <utility>
 #include <vector>
 
+#include "bigint.h"
+#include "linalg.h"
 #include "order.h"
 #include "numbers.h"
 #include "parse.h"
@@ -39,10 +42,26 @@ Stone ParseStone(const std::string &s)
     return Stone{pos[0], pos[1], pos[2], v[0], v[1], v[2]};
 }
 
-template <typename T>
-T Det(T a, T b, T c, T d)
+using Vec = std::array<BigRat, 3>;
+
+Vec Pos(const Stone &s)
 {
-    return a * d - b * c;
+    return {(long long)s.x, (long long)s.y, (long long)s.z};
+}
+
+Vec Vel(const Stone &s)
+{
+    return {(long long)s.vx, (long long)s.vy, (long long)s.vz};
+}
+
+Vec Sub(const Vec &a, const Vec &b)
+{
+    return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+Vec Cross(const Vec &a, const Vec &b)
+{
+    return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
 }
 
 int main()
@@ -54,39 +73,34 @@ int main()
         stones.push_back(ParseStone(line));
     }
 
-    // With lots of different ad-hoc runs, this is what it comes down to.
-    double vx = 263, vy = 120, vz = 21;
-    long long meet_x = 118378223846841, meet_y = 228996474589321, meet_z = 259397320329497;
-    std::cout << meet_x + meet_y + meet_z << std::endl;
-
-    return 0;
-
-    for (int i = 0; i < 5; i++)
+    // The rock at p with velocity v hits stone i iff (p - p_i) x (v - v_i) == 0.
+    // Subtracting these for stones i and j cancels the p x v term:
+    //
+    // p x (v_j - v_i) + (p_j - p_i) x v == p_j x v_j - p_i x v_i,
+    //
+    // which is linear in (p, v). Two pairs of stones give 6 equations.
+    Matrix<BigRat> a(6, 6);
+    std::vector<BigRat> b(6);
+    for (int k = 0; k < 2; k++)
     {
-        for (int j = i + 1; j < 5; j++)
+        const Stone &si = stones[0], &sj = stones[k + 1];
+        Vec w = Sub(Vel(sj), Vel(si)), u = Sub(Pos(sj), Pos(si));
+        Vec rhs = Sub(Cross(Pos(sj), Vel(sj)), Cross(Pos(si), Vel(si)));
+        BigRat rows[3][6] = {
+            {0, w[2], -w[1], 0, -u[2], u[1]},
+            {-w[2], 0, w[0], u[2], 0, -u[0]},
+            {w[1], -w[0], 0, -u[1], u[0], 0},
+        };
+        for (int i = 0; i < 3; i++)
         {
-            Stone a = stones[i];
-            Stone b = stones[j];
-
-            a.vx -= vx;
-            a.vy -= vy;
-            b.vx -= vx;
-            b.vy -= vy;
-
-            double m11 = a.vx, m12 = -b.vx, y1 = b.x - a.x;
-            double m21 = a.vy, m22 = -b.vy, y2 = b.y - a.y;
-            double d = Det(m11, m21, m12, m22);
-
-            if (d == 0)
-            {
-                continue;
-            }
-            double t1 = Det(y1, y2, m12, m22) / d;
-            double t2 = Det(m11, m21, y1, y2) / d;
-
-            std::cout << (long long)(a.x + t1 * a.vx) << " " << (long long)(a.y + t1 * a.vy) << std::endl;
+            std::copy(rows[i], rows[i] + 6, a[3 * k + i]);
+            b[3 * k + i] = rhs[i];
         }
     }
+    assert(Rank(a) == 6);
+    std::optional<std::vector<BigRat>> x = SolveLinear(a, b);
+    assert(x.has_value());
+    std::cout << (*x)[0] + (*x)[1] + (*x)[2] << std::endl;
 
     return 0;
 }
\ No newline at end of file
@@ -1,42 +1,33 @@
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include "parse.h"
-
-std::unordered_map<long long, long long> Evolve(
-    const std::unordered_map<long long, long long>& cs) {
-    std::unordered_map<long long, long long> ds;
-    for (const auto& [x, c] : cs) {
-        if (x == 0) {
-            ds[1] += c;
-        } else {
-            std::string s = std::to_string(x);
-            if (s.length() % 2 == 0) {
-                ds[std::stoll(s.substr(0, s.length() / 2))] += c;
-                ds[std::stoll(s.substr(s.length() / 2, s.length() / 2))] += c;
-            } else {
-                ds[x * 2024] += c;
-            }
-        }
-    }
-    return ds;
-}
+#include "transitions.h"
 
 int main() {
     std::string input = Trim(GetContents("input.txt"));
     std::vector<long long> xs = ParseVector<long long>(input);
 
-    std::unordered_map<long long, long long> cs;
-    for (long long x : xs) {
-        cs[x]++;
-    }
-
-    for (int i = 0; i < 75; i++) {
-        cs = Evolve(cs);
-    }
+    // Only a few thousand distinct numbers ever appear, so the stones are a
+    // linear evolution of counts over them.
+    TransitionSystem<long long> stones(xs, [](auto& t, long long x) {
+        if (x == 0) {
+            t.Add(1);
+            return;
+        }
+        std::string s = std::to_string(x);
+        if (s.length() % 2 == 0) {
+            t.Add(std::stoll(s.substr(0, s.length() / 2)));
+            t.Add(std::stoll(s.substr(s.length() / 2, s.length() / 2)));
+        } else {
+            t.Add(x * 2024);
+        }
+    });
+    std::vector<long long> counts = stones.Advance(stones.Counts(xs), 75);
 
     long long answer = 0;
-    for (const auto &[_, c] : cs) {
+    for (long long c : counts) {
         answer += c;
     }
     std::cout << answer << std::endl;
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "collections.h"
+#include "linalg.h"
 #include "parse.h"
 
 struct Machine {
@@ -29,24 +30,28 @@ Machine ParseMachine(const std::vector<std::string>& par) {
     return m;
 }
 
-template <typename T>
-T Det(T a, T b, T c, T d) {
-    return a * d - b * c;
-}
-
 int main() {
     NestedVector<2, std::string> pars = Split(Split(Trim(GetContents("input.txt")), "\n"), {""});
 
-    long long answer = 0;
-    for (const std::vector<std::string>& par : pars) {
-        Machine m = ParseMachine(par);
+    // Presses i, j of the buttons solve {ax * i + bx * j == prize_x,
+    // ay * i + by * j == prize_y}. Solve all machines' systems at once.
+    LinearSystemBatch<2, long long> batch(pars.size());
+    for (int s = 0; s < batch.Size(); s++) {
+        Machine m = ParseMachine(pars[s]);
         m.prize_x += 10000000000000LL;
         m.prize_y += 10000000000000LL;
+        batch.A(s, 0, 0) = m.ax;
+        batch.A(s, 0, 1) = m.bx;
+        batch.A(s, 1, 0) = m.ay;
+        batch.A(s, 1, 1) = m.by;
+        batch.B(s, 0) = m.prize_x;
+        batch.B(s, 1) = m.prize_y;
+    }
+    batch.Solve();
 
-        long long d = Det(m.ax, m.ay, m.bx, m.by);
-        long long i = Det(m.prize_x, m.prize_y, m.bx, m.by);
-        long long j = Det(m.ax, m.ay, m.prize_x, m.prize_y);
-
+    long long answer = 0;
+    for (int s = 0; s < batch.Size(); s++) {
+        long long d = batch.Det(s), i = batch.Numerator(s, 0), j = batch.Numerator(s, 1);
         assert(d != 0);
         if (i % d != 0 || j % d != 0) {
             continue;
@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "grid.h"
+#include "numbers.h"
 #include "parse.h"
 
 const Box kBox = {103, 101};
@@ -46,29 +47,33 @@ int main() {
         robots.push_back(ParseRobot(line));
     }
 
-    std::ofstream out("output.txt");
-    int t;
-    for (t = 0; t < kBox.size_i * kBox.size_j; t++) {
-        int var_i = VarI(robots);
-        if (var_i < 100000000) {
-            out << "Low I variance: " << t << " " << var_i << std::endl;
-            PrintRobots(robots, out);
-        }
-
-        int var_j = VarJ(robots);
-        if (var_j < 100000000) {
-            out << "Low J variance: " << t << " " << var_j << std::endl;
-            PrintRobots(robots, out);
+    // Coordinates i and j move independently, repeating after size_i and
+    // size_j steps respectively. Find when each of them clusters, then
+    // combine the two times with the Chinese remainder theorem.
+    int t_i = -1, t_j = -1;
+    std::vector<PosDir> cur = robots;
+    for (int t = 0; t < std::max(kBox.size_i, kBox.size_j); t++) {
+        if (t_i == -1 && t < kBox.size_i && VarI(cur) < 100000000) {
+            t_i = t;
         }
-
-        if (var_i < 100000000 && var_j < 100000000) {
-            break;
+        if (t_j == -1 && t < kBox.size_j && VarJ(cur) < 100000000) {
+            t_j = t;
         }
-
-        for (PosDir& robot : robots) {
+        for (PosDir& robot : cur) {
             robot.pos = kBox.Wrap(robot.pos + robot.dir);
         }
     }
+    assert(t_i != -1 && t_j != -1);
+    auto solution = SolveCRT(t_i, kBox.size_i, t_j, kBox.size_j);
+    assert(solution.has_value());
+    int t = solution->first;
+
+    for (PosDir& robot : robots) {
+        robot.pos = kBox.Wrap(robot.pos + robot.dir * t);
+    }
+    std::ofstream out("output.txt");
+    out << "Time " << t << ":" << std::endl;
+    PrintRobots(robots, out);
 
     std::cout << t << std::endl;
     return 0;
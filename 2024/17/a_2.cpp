@@ -12,4 +12,5 @@ int main() {
         a >>= 3;
     } while (a != 0);
     std::cout << FormatVector(output, ",") << std::endl;
+    return 0;
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
+#include <functional>
 #include <iostream>
 #include <string>
 #include <vector>
 
 #include "collections.h"
+#include "parallel.h"
 #include "parse.h"
 
 int main() {
@@ -12,22 +14,24 @@ int main() {
         s = Trim(s);
     }
 
-    long long answer = 0;
-    for (const std::string& s : queries) {
-        std::vector<long long> d(s.size() + 1, 0);
-        d[s.size()] = 1;
-        for (int i = s.size() - 1; i >= 0; i--) {
-            for (const std::string& piece : pieces) {
-                if (i + piece.size() > s.size()) {
-                    continue;
-                }
-                if (std::equal(piece.begin(), piece.end(), s.begin() + i)) {
-                    d[i] += d[i + piece.size()];
+    long long answer = ParallelMapReduce(
+        queries,
+        [&](const std::string& s) {
+            std::vector<long long> d(s.size() + 1, 0);
+            d[s.size()] = 1;
+            for (int i = s.size() - 1; i >= 0; i--) {
+                for (const std::string& piece : pieces) {
+                    if (i + piece.size() > s.size()) {
+                        continue;
+                    }
+                    if (std::equal(piece.begin(), piece.end(), s.begin() + i)) {
+                        d[i] += d[i + piece.size()];
+                    }
                 }
             }
-        }
-        answer += d[0];
-    }
+            return d[0];
+        },
+        std::plus<long long>());
 
     std::cout << answer << std::endl;
     return 0;
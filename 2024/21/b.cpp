@@ -6,6 +6,7 @@
 
 #include "collections.h"
 #include "grid.h"
+#include "numbers.h"
 #include "parse.h"
 
 using Keypad = std::unordered_map<char, Coord>;
@@ -23,14 +24,17 @@ const Keypad kArrows = {
 };
 // clang-format on
 
-long long MoveCost(Coord, Coord, const Keypad&, int);
+// Every sum of costs is checked for overflow.
+using Cost = Checked<long long>;
+
+Cost MoveCost(Coord, Coord, const Keypad&, int);
 
 // How many human keypresses it costs to push a given sequence of keys on a
 // given keypad, assuming that the pointer on this keypad and all the pointers
 // on keypads upstream start on 'A' and finish on 'A'.
-long long StrCost(const std::string& s, const Keypad& kp, int robots) {
+Cost StrCost(const std::string& s, const Keypad& kp, int robots) {
     Coord pos = kp.at('A');
-    long long result = 0;
+    Cost result = 0;
     for (char c : s) {
         Coord next = kp.at(c);
         result += MoveCost(pos, next, kp, robots) + 1;
@@ -43,16 +47,17 @@ long long StrCost(const std::string& s, const Keypad& kp, int robots) {
 // How many human keypresses it costs to move the pointer on a given keypad
 // from `start` to `end`, assuming all pointers upstream start on 'A' and finish
 // on 'A'.
-long long MoveCost(Coord start, Coord end, const Keypad& kp, int robots) {
+Cost MoveCost(Coord start, Coord end, const Keypad& kp, int robots) {
     static NestedVector<5, long long> d = ConstVector(-1ll, 4, 3, 4, 3, 27);
-    long long& result = d[start.i][start.j][end.i][end.j][robots];
-    if (result != -1) {
-        return result;
+    long long& memo = d[start.i][start.j][end.i][end.j][robots];
+    if (memo != -1) {
+        return memo;
     }
 
     if (robots == 0) {
         // The pointer is a human finger, it costs nothing to move it.
-        return result = 0;
+        memo = 0;
+        return 0;
     }
 
     // The pointer is a robotic arm. Try to move it in two ways:
@@ -60,20 +65,22 @@ long long MoveCost(Coord start, Coord end, const Keypad& kp, int robots) {
     std::string i_moves = (end.i > start.i) ? std::string(end.i - start.i, 'v') : std::string(start.i - end.i, '^');
     std::string j_moves = (end.j > start.j) ? std::string(end.j - start.j, '>') : std::string(start.j - end.j, '<');
 
-    result = std::numeric_limits<long long>::max();
+    Cost result = std::numeric_limits<long long>::max();
     if (Coord{start.i, end.j} != kp.at(' ')) {
         result = std::min(result, StrCost(j_moves + i_moves, kArrows, robots - 1));
     }
     if (Coord{end.i, start.j} != kp.at(' ')) {
         result = std::min(result, StrCost(i_moves + j_moves, kArrows, robots - 1));
     }
+    memo = result.Val();
     return result;
 }
 
 int main() {
-    long long answer = 0;
+    // The costs grow exponentially with the number of robots.
+    Cost answer = 0;
     for (const std::string& s : Split(Trim(GetContents("input.txt")), "\n")) {
-        answer += std::stoll(s) * StrCost(s, kDigits, 26);
+        answer += Cost(std::stoll(s)) * StrCost(s, kDigits, 26);
     }
     std::cout << answer << std::endl;
     return 0;
@@ -1,6 +1,8 @@
+#include <functional>
 #include <iostream>
 #include <string>
 
+#include "parallel.h"
 #include "parse.h"
 
 const long long kMod = 16777216;
@@ -13,15 +15,17 @@ long long Step(long long x) {
 }
 
 int main() {
-    long long answer = 0;
-    for (const auto& line :  Split(Trim(GetContents("input.txt")), "\n")) {
-        long long x = std::stoll(line);
-        for (int i = 0; i < 2000; i++) {
-            x = Step(x);
-        }
-        answer += x;
-    }
-    
+    long long answer = ParallelMapReduce(
+        Split(Trim(GetContents("input.txt")), "\n"),
+        [](const std::string& line) {
+            long long x = std::stoll(line);
+            for (int i = 0; i < 2000; i++) {
+                x = Step(x);
+            }
+            return x;
+        },
+        std::plus<long long>());
+
     std::cout << answer << std::endl;
     return 0;
 }
\ No newline at end of file
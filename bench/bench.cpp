@@ -0,0 +1,466 @@
+// Runs every solution several times from its own directory and records wall
+// time, user and system CPU time and peak memory. Results are appended to a
+// CSV history file, and the new run is compared to the previous one there.
+//
+// Usage:
+//
+// bench --source DIR --build DIR [--runs N] [--timeout SECONDS] [--history FILE] [PREFIX...]
+//
+// Only solutions whose names (like 2024_11_b) start with one of the prefixes
+// are run, or all of them if there are none. The `bench` CMake target builds
+// everything and runs this over the whole repository.
+//
+// A run that takes longer than the timeout (60 seconds by default, none if
+// 0) is killed and recorded with status 124, like timeout(1) does, and the
+// remaining runs of that solution are skipped.
+//
+// Solutions that time their phases with profiler.h write them to
+// <build>/profiles/<name>.json, and the report shows the share of each
+// top-level phase.
+//
+// Measurements come from wait4(), so this needs a POSIX system.
+
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "parse.h"
+
+namespace fs = std::filesystem;
+
+struct Solution {
+    std::string name;  // 2024_11_b
+    fs::path dir;      // Where input.txt is.
+    fs::path binary;
+    fs::path profile;  // Where PhaseProfiler writes its JSON.
+};
+
+// One run of one solution.
+struct Sample {
+    double wall_ms;
+    double user_ms;
+    double sys_ms;
+    long max_rss_kb;
+    int status;
+    std::string output;
+};
+
+// Summary of all runs of one solution: one row of the history file.
+struct Result {
+    std::string name;
+    int runs;
+    double wall_ms;  // Median.
+    double wall_min_ms;
+    double user_ms;  // Median.
+    double sys_ms;   // Median.
+    long max_rss_kb;
+    int status;      // Of the first failed run, or 0.
+    size_t output_hash;
+    // Shares of the top-level phases of the last run, like "parse 2%
+    // search 97%", if the solution is profiled. Not kept in the history.
+    std::string phases;
+};
+
+const char kHistoryHeader[] =
+    "run,time,solution,runs,wall_ms,wall_min_ms,user_ms,sys_ms,max_rss_kb,status,output_hash";
+
+const rlim_t kStackBytes = 256000000;
+
+const int kTimeoutStatus = 124;
+
+double ToMs(const timeval& tv) {
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// Solutions are YYYY/DD/*.cpp, built into <build>/YYYY_DD_<part>.
+std::vector<Solution> FindSolutions(const fs::path& source, const fs::path& build) {
+    std::vector<Solution> result;
+    std::regex year_re("[0-9]{4}"), day_re("[0-9]{2}");
+    for (const auto& year : fs::directory_iterator(source)) {
+        if (!year.is_directory() || !std::regex_match(year.path().filename().string(), year_re)) {
+            continue;
+        }
+        for (const auto& day : fs::directory_iterator(year.path())) {
+            if (!day.is_directory() || !std::regex_match(day.path().filename().string(), day_re)) {
+                continue;
+            }
+            for (const auto& file : fs::directory_iterator(day.path())) {
+                if (file.path().extension() != ".cpp") {
+                    continue;
+                }
+                std::string name = year.path().filename().string() + "_" +
+                                   day.path().filename().string() + "_" +
+                                   file.path().stem().string();
+                result.push_back(Solution{name, day.path(), build / name,
+                                          build / "profiles" / (name + ".json")});
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(),
+              [](const Solution& a, const Solution& b) { return a.name < b.name; });
+    return result;
+}
+
+// Runs the binary in its directory with stdout captured and stderr dropped,
+// and kills it after timeout_s seconds unless that's 0.
+Sample RunOnce(const Solution& s, int timeout_s) {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+        perror("pipe");
+        exit(1);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(pipe_fds[1], STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        close(null_fd);
+        // Deep recursion needs the same large stack that the Windows build
+        // gets from the linker.
+        rlimit stack;
+        if (getrlimit(RLIMIT_STACK, &stack) == 0 && stack.rlim_cur < kStackBytes) {
+            stack.rlim_cur = std::min(kStackBytes, stack.rlim_max);
+            setrlimit(RLIMIT_STACK, &stack);
+        }
+        if (chdir(s.dir.c_str()) != 0) {
+            _exit(126);
+        }
+        setenv("AOC_PROFILE", s.profile.c_str(), 1);
+        execl(s.binary.c_str(), s.binary.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+
+    close(pipe_fds[1]);
+    Sample sample;
+    auto deadline = start + std::chrono::seconds(timeout_s);
+    bool timed_out = false;
+    while (true) {
+        int wait_ms = -1;
+        if (timeout_s > 0) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            wait_ms = std::max<long long>(0, left.count());
+        }
+        pollfd fd = {pipe_fds[0], POLLIN, 0};
+        int ready = poll(&fd, 1, wait_ms);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready == 0) {
+            kill(pid, SIGKILL);
+            timed_out = true;
+            break;
+        }
+        char buffer[4096];
+        ssize_t n = read(pipe_fds[0], buffer, sizeof(buffer));
+        if (n <= 0) {
+            break;
+        }
+        sample.output.append(buffer, n);
+    }
+    close(pipe_fds[0]);
+
+    // The child can also keep running after closing its stdout.
+    int wstatus;
+    rusage usage;
+    while (true) {
+        pid_t done = wait4(pid, &wstatus, timed_out ? 0 : WNOHANG, &usage);
+        if (done == pid) {
+            break;
+        }
+        if (done < 0) {
+            perror("wait4");
+            exit(1);
+        }
+        if (timeout_s > 0 && std::chrono::steady_clock::now() >= deadline) {
+            kill(pid, SIGKILL);
+            timed_out = true;
+        } else {
+            usleep(100);
+        }
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    sample.wall_ms = std::chrono::duration<double, std::milli>(finish - start).count();
+    sample.user_ms = ToMs(usage.ru_utime);
+    sample.sys_ms = ToMs(usage.ru_stime);
+    sample.max_rss_kb = usage.ru_maxrss;
+    if (timed_out) {
+        sample.status = kTimeoutStatus;
+    } else if (WIFEXITED(wstatus)) {
+        sample.status = WEXITSTATUS(wstatus);
+    } else {
+        // Like the shell does for signals.
+        sample.status = 128 + WTERMSIG(wstatus);
+    }
+    return sample;
+}
+
+double Median(std::vector<double> xs) {
+    std::sort(xs.begin(), xs.end());
+    int n = xs.size();
+    return (n % 2 == 1) ? xs[n / 2] : (xs[n / 2 - 1] + xs[n / 2]) / 2;
+}
+
+// Reads the top-level phases from a file written by
+// PhaseProfiler::WriteJson(), which has one phase per line.
+std::string LoadPhases(const fs::path& profile) {
+    if (!fs::exists(profile)) {
+        return "";
+    }
+    std::regex total_re(R"re(^\{"total_ms": ([0-9.]+))re");
+    std::regex phase_re(R"re(^\{"path": "((?:[^"\\]|\\.)*)", "depth": 1, "ms": ([0-9.]+))re");
+    double total = 0;
+    std::ostringstream result;
+    for (const std::string& line : Split(GetContents(profile.string()), "\n")) {
+        std::smatch m;
+        if (std::regex_search(line, m, total_re)) {
+            total = std::stod(m[1]);
+        } else if (std::regex_search(line, m, phase_re) && total > 0) {
+            result << (result.tellp() > 0 ? " " : "") << m[1] << " " << std::fixed
+                   << std::setprecision(0) << std::stod(m[2]) / total * 100 << "%";
+        }
+    }
+    return result.str();
+}
+
+Result Measure(const Solution& s, int runs, int timeout_s) {
+    // Drop the profile of an older build, which may have had other phases.
+    fs::remove(s.profile);
+    std::vector<Sample> samples;
+    for (int i = 0; i < runs; i++) {
+        samples.push_back(RunOnce(s, timeout_s));
+        // Another try would most likely just time out again.
+        if (samples.back().status == kTimeoutStatus) {
+            break;
+        }
+    }
+
+    Result r{s.name, (int)samples.size(), 0, 0, 0, 0, 0, 0, std::hash<std::string>()(samples[0].output)};
+    std::vector<double> wall, user, sys;
+    for (const Sample& sample : samples) {
+        wall.push_back(sample.wall_ms);
+        user.push_back(sample.user_ms);
+        sys.push_back(sample.sys_ms);
+        r.max_rss_kb = std::max(r.max_rss_kb, sample.max_rss_kb);
+        if (r.status == 0) {
+            r.status = sample.status;
+        }
+    }
+    r.wall_ms = Median(wall);
+    r.wall_min_ms = *std::min_element(wall.begin(), wall.end());
+    r.user_ms = Median(user);
+    r.sys_ms = Median(sys);
+    r.phases = LoadPhases(s.profile);
+    return r;
+}
+
+// Results of the latest run in the history file, by solution, and the id of
+// that run, or 0 if the history is empty.
+std::pair<long long, std::map<std::string, Result>> LoadLastRun(const fs::path& history) {
+    std::map<long long, std::map<std::string, Result>> runs;
+    if (!fs::exists(history)) {
+        return {0, {}};
+    }
+    for (const std::string& line : Split(Trim(GetContents(history.string())), "\n")) {
+        if (line.empty() || line == kHistoryHeader) {
+            continue;
+        }
+        std::vector<std::string> f = Split(line, ",");
+        if (f.size() != 11) {
+            std::cerr << "Skipping malformed history line: " << line << std::endl;
+            continue;
+        }
+        Result r{f[2],
+                 std::stoi(f[3]),
+                 std::stod(f[4]),
+                 std::stod(f[5]),
+                 std::stod(f[6]),
+                 std::stod(f[7]),
+                 std::stol(f[8]),
+                 std::stoi(f[9]),
+                 std::stoull(f[10])};
+        runs[std::stoll(f[0])][r.name] = r;
+    }
+    if (runs.empty()) {
+        return {0, {}};
+    }
+    return *runs.rbegin();
+}
+
+void AppendHistory(const fs::path& history, long long run, const std::vector<Result>& results) {
+    bool fresh = !fs::exists(history) || fs::file_size(history) == 0;
+    std::ofstream out(history, std::ios::app);
+    if (fresh) {
+        out << kHistoryHeader << "\n";
+    }
+    std::time_t now = std::time(nullptr);
+    char time_str[32];
+    std::strftime(time_str, sizeof(time_str), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    out << std::fixed << std::setprecision(3);
+    for (const Result& r : results) {
+        out << run << "," << time_str << "," << r.name << "," << r.runs << "," << r.wall_ms << ","
+            << r.wall_min_ms << "," << r.user_ms << "," << r.sys_ms << "," << r.max_rss_kb << ","
+            << r.status << "," << r.output_hash << "\n";
+    }
+}
+
+// Prints the results, and the change from the previous run where there is
+// one. Timing noise below kNoiseMs or kNoiseRatio is not flagged.
+void Report(const std::vector<Result>& results, const std::map<std::string, Result>& previous) {
+    const double kNoiseMs = 5, kNoiseRatio = 0.1;
+    std::cout << std::left << std::setw(14) << "solution" << std::right << std::setw(11)
+              << "wall ms" << std::setw(11) << "user ms" << std::setw(11) << "sys ms"
+              << std::setw(11) << "rss KB" << std::setw(11) << "prev ms" << std::setw(9)
+              << "change" << "  notes" << std::endl;
+
+    double total = 0, total_previous = 0;
+    int slower = 0, faster = 0;
+    std::cout << std::fixed << std::setprecision(1);
+    for (const Result& r : results) {
+        std::cout << std::left << std::setw(14) << r.name << std::right << std::setw(11)
+                  << r.wall_ms << std::setw(11) << r.user_ms << std::setw(11) << r.sys_ms
+                  << std::setw(11) << r.max_rss_kb;
+        std::string notes;
+        if (r.status == kTimeoutStatus) {
+            notes += " TIMEOUT";
+        } else if (r.status != 0) {
+            notes += " exit=" + std::to_string(r.status);
+        }
+        total += r.wall_ms;
+
+        auto it = previous.find(r.name);
+        if (it == previous.end()) {
+            std::cout << std::setw(11) << "-" << std::setw(9) << "-";
+            notes += " new";
+        } else {
+            const Result& p = it->second;
+            total_previous += p.wall_ms;
+            double diff = r.wall_ms - p.wall_ms;
+            double ratio = (p.wall_ms > 0) ? diff / p.wall_ms : 0;
+            std::ostringstream change;
+            change << std::showpos << std::fixed << std::setprecision(0) << ratio * 100 << "%";
+            std::cout << std::setw(11) << p.wall_ms << std::setw(9) << change.str();
+            if (std::abs(diff) > kNoiseMs && std::abs(ratio) > kNoiseRatio) {
+                notes += (diff > 0) ? " SLOWER" : " faster";
+                (diff > 0 ? slower : faster)++;
+            }
+            if (p.output_hash != r.output_hash) {
+                notes += " OUTPUT CHANGED";
+            }
+            if (p.status != r.status) {
+                notes += " status was " + std::to_string(p.status);
+            }
+        }
+        if (!r.phases.empty()) {
+            notes += " [" + r.phases + "]";
+        }
+        std::cout << " " << notes << std::endl;
+    }
+
+    std::cout << "Total wall time: " << total << " ms";
+    if (total_previous > 0) {
+        std::cout << " (previously " << total_previous << " ms for the same solutions; " << slower
+                  << " slower, " << faster << " faster)";
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    fs::path source = ".", build = ".", history;
+    int runs = 5;
+    int timeout_s = 60;
+    std::vector<std::string> prefixes;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--source") {
+            source = value();
+        } else if (arg == "--build") {
+            build = value();
+        } else if (arg == "--runs") {
+            runs = std::stoi(value());
+        } else if (arg == "--timeout") {
+            timeout_s = std::stoi(value());
+        } else if (arg == "--history") {
+            history = value();
+        } else {
+            prefixes.push_back(arg);
+        }
+    }
+    assert(runs > 0 && timeout_s >= 0);
+    source = fs::absolute(source);
+    build = fs::absolute(build);
+    if (history.empty()) {
+        history = build / "bench_history.csv";
+    }
+    fs::create_directories(build / "profiles");
+
+    std::vector<Solution> solutions;
+    for (const Solution& s : FindSolutions(source, build)) {
+        bool selected = prefixes.empty() || std::any_of(prefixes.begin(), prefixes.end(),
+                                                        [&](const std::string& prefix) {
+                                                            return s.name.starts_with(prefix);
+                                                        });
+        if (!selected) {
+            continue;
+        }
+        if (!fs::exists(s.binary)) {
+            std::cerr << "Not built, skipping: " << s.name << std::endl;
+        } else if (!fs::exists(s.dir / "input.txt")) {
+            std::cerr << "No input.txt, skipping: " << s.name << std::endl;
+        } else {
+            solutions.push_back(s);
+        }
+    }
+
+    std::vector<Result> results;
+    for (const Solution& s : solutions) {
+        std::cerr << "Running " << s.name << "..." << std::endl;
+        results.push_back(Measure(s, runs, timeout_s));
+    }
+
+    auto [last_run, previous] = LoadLastRun(history);
+    long long run = std::max<long long>(last_run + 1, std::time(nullptr));
+    Report(results, previous);
+    AppendHistory(history, run, results);
+    std::cout << "Appended to " << history.string() << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,444 @@
+// Generates inputs in the formats of some puzzles, at any size, to see how
+// solutions scale beyond the real inputs. The output goes to stdout and only
+// depends on the arguments.
+//
+// Usage:
+//
+// generate KIND [--size N] [--seed S] [OPTIONS]
+//
+// maze      N x N maze like 2024/16, with S in the bottom left corner and E in
+//           the top right one. --walls D is the share of walls inside the
+//           border, from 0.25 (rooms with pillars) to 0.5 (a perfect maze
+//           with a single path between any two cells); 0.47 by default, as
+//           in the real input. N is rounded up to an odd number.
+// track     N x N racetrack like 2024/20: a single winding path from S to E.
+// digits    N x N grid of digits 1-9 like 2023/17.
+// wires     Graph like 2023/25 with N nodes: two random halves with average
+//           degree --degree D (default 4.5), joined by exactly three edges.
+// network   Graph like 2024/23 with N nodes, almost all with exactly
+//           --degree D neighbors (default 13) and none with more, and a
+//           planted clique of --clique K <= D + 1 nodes (default 13).
+// sensors   N sensors like 2022/15 (at least 4). All points of the search
+//           area but one are covered; that one is printed to stderr.
+// numbers   N lines of --columns C random numbers from 1 to --max M, like
+//           2024/01 (C = 2, the default) or 2024/22 (C = 1, M = 16777215).
+//
+// The default sizes are those of the real inputs. For example, to time
+// 2024/16/a on a maze ten times as wide:
+//
+// generate maze --size 1401 > /tmp/maze/input.txt
+// aoc run 2024/16/a --input /tmp/maze/input.txt
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "grid.h"
+#include "random.h"
+
+// The --key value pairs of the command line.
+class Options {
+   public:
+    Options(int argc, char* argv[]) {
+        for (int i = 0; i < argc; i++) {
+            std::string arg = argv[i];
+            if (!arg.starts_with("--") || i + 1 >= argc) {
+                std::cerr << "Expected --option value, got " << arg << std::endl;
+                exit(2);
+            }
+            values_[arg.substr(2)] = argv[++i];
+        }
+    }
+
+    double Get(const std::string& name, double default_value) {
+        used_.insert(name);
+        auto it = values_.find(name);
+        return it == values_.end() ? default_value : std::stod(it->second);
+    }
+
+    long long GetInt(const std::string& name, long long default_value) {
+        used_.insert(name);
+        auto it = values_.find(name);
+        return it == values_.end() ? default_value : std::stoll(it->second);
+    }
+
+    // Dies if an option was given that the kind doesn't have.
+    void CheckAllUsed() const {
+        for (const auto& [name, _] : values_) {
+            if (!used_.contains(name)) {
+                std::cerr << "Unknown option --" << name << std::endl;
+                exit(2);
+            }
+        }
+    }
+
+   private:
+    std::map<std::string, std::string> values_;
+    std::set<std::string> used_;
+};
+
+void Print(const std::vector<std::string>& lines) {
+    for (const std::string& line : lines) {
+        std::cout << line << "\n";
+    }
+}
+
+bool Inside(const Coord& c, int side) {
+    return c.i > 0 && c.i < side - 1 && c.j > 0 && c.j < side - 1;
+}
+
+// Cells at odd coordinates connected by a randomized DFS, so that there's
+// exactly one path between any two of them. side must be odd.
+std::vector<std::string> PerfectMaze(int side, Random& random) {
+    std::vector<std::string> maze(side, std::string(side, '#'));
+    std::vector<Coord> stack = {{1, 1}};
+    maze[1][1] = '.';
+    while (!stack.empty()) {
+        Coord c = stack.back();
+        std::vector<Coord> dirs;
+        for (const Coord& dir : {kNorth, kSouth, kWest, kEast}) {
+            Coord next = c + 2 * dir;
+            if (Inside(next, side) && maze[next.i][next.j] == '#') {
+                dirs.push_back(dir);
+            }
+        }
+        if (dirs.empty()) {
+            stack.pop_back();
+            continue;
+        }
+        Coord dir = dirs[random.Below(dirs.size())];
+        Coord wall = c + dir, next = c + 2 * dir;
+        maze[wall.i][wall.j] = maze[next.i][next.j] = '.';
+        stack.push_back(next);
+    }
+    return maze;
+}
+
+int OddSide(long long size) {
+    assert(size >= 5 && size <= 100000);
+    return size | 1;
+}
+
+void Maze(Options& options, Random& random) {
+    int side = OddSide(options.GetInt("size", 141));
+    double walls = options.Get("walls", 0.47);
+    options.CheckAllUsed();
+
+    std::vector<std::string> maze = PerfectMaze(side, random);
+    // Walls between two cells can go without cutting anything off, and
+    // every one that goes makes a loop.
+    std::vector<Coord> removable;
+    long long wall_count = 0;
+    for (int i = 1; i < side - 1; i++) {
+        for (int j = 1; j < side - 1; j++) {
+            if (maze[i][j] == '#') {
+                wall_count++;
+                if ((i + j) % 2 == 1) {
+                    removable.emplace_back(i, j);
+                }
+            }
+        }
+    }
+    random.Shuffle(removable);
+    long long target = walls * (side - 2) * (side - 2);
+    for (int k = 0; k < (int)removable.size() && wall_count > target; k++, wall_count--) {
+        maze[removable[k].i][removable[k].j] = '.';
+    }
+
+    maze[side - 2][1] = 'S';
+    maze[1][side - 2] = 'E';
+    Print(maze);
+}
+
+void Track(Options& options, Random& random) {
+    int side = OddSide(options.GetInt("size", 141));
+    options.CheckAllUsed();
+
+    // The path between the corners of a perfect maze made by DFS winds
+    // through a good part of it.
+    std::vector<std::string> maze = PerfectMaze(side, random);
+    Coord start(side - 2, 1), end(1, side - 2);
+    std::vector<std::vector<Coord>> parent(side, std::vector<Coord>(side, Coord(-1, -1)));
+    std::vector<Coord> queue = {start};
+    parent[start.i][start.j] = start;
+    for (int k = 0; k < (int)queue.size(); k++) {
+        for (const Coord& dir : {kNorth, kSouth, kWest, kEast}) {
+            Coord next = queue[k] + dir;
+            if (maze[next.i][next.j] != '#' && parent[next.i][next.j] == Coord(-1, -1)) {
+                parent[next.i][next.j] = queue[k];
+                queue.push_back(next);
+            }
+        }
+    }
+
+    std::vector<std::string> track(side, std::string(side, '#'));
+    for (Coord c = end; c != start; c = parent[c.i][c.j]) {
+        track[c.i][c.j] = '.';
+    }
+    track[start.i][start.j] = 'S';
+    track[end.i][end.j] = 'E';
+    Print(track);
+}
+
+void Digits(Options& options, Random& random) {
+    int side = options.GetInt("size", 141);
+    options.CheckAllUsed();
+    assert(side >= 1);
+    std::vector<std::string> grid(side, std::string(side, '.'));
+    for (std::string& row : grid) {
+        for (char& c : row) {
+            c = '1' + random.Below(9);
+        }
+    }
+    Print(grid);
+}
+
+// count distinct random names of lowercase letters, at least min_length
+// long and longer if there aren't enough names of that length.
+std::vector<std::string> MakeNames(int count, int min_length, Random& random) {
+    int length = min_length;
+    while (std::pow(26.0, length) < 4.0 * count) {
+        length++;
+    }
+    std::set<std::string> used;
+    std::vector<std::string> names;
+    while ((int)names.size() < count) {
+        std::string name(length, 'a');
+        for (char& c : name) {
+            c = 'a' + random.Below(26);
+        }
+        if (used.insert(name).second) {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
+// Undirected simple graph on nodes 0..n-1.
+class Graph {
+   public:
+    explicit Graph(int n) : degrees_(n) {}
+
+    bool Connect(int a, int b) {
+        if (a == b || !edges_.insert(std::minmax(a, b)).second) {
+            return false;
+        }
+        degrees_[a]++;
+        degrees_[b]++;
+        return true;
+    }
+
+    int Degree(int a) const {
+        return degrees_[a];
+    }
+
+    const std::set<std::pair<int, int>>& Edges() const {
+        return edges_;
+    }
+
+   private:
+    std::vector<int> degrees_;
+    std::set<std::pair<int, int>> edges_;
+};
+
+void Wires(Options& options, Random& random) {
+    int n = options.GetInt("size", 1500);
+    double degree = options.Get("degree", 4.5);
+    options.CheckAllUsed();
+    assert(n >= 12 && degree >= 4);
+
+    // Each half is connected through a random spanning tree, and gets random
+    // edges up to the average degree. With every node having at least 4
+    // neighbors, the three edges between the halves are almost surely the
+    // only cut of size 3.
+    Graph graph(n);
+    for (auto [lo, hi] : {std::pair(0, n / 2), std::pair(n / 2, n)}) {
+        int size = hi - lo;
+        for (int k = 1; k < size; k++) {
+            graph.Connect(lo + k, lo + random.Below(k));
+        }
+        long long edges = size - 1;
+        while (edges < degree * size / 2) {
+            edges += graph.Connect(lo + random.Below(size), lo + random.Below(size));
+        }
+        for (int a = lo; a < hi; a++) {
+            while (graph.Degree(a) < 4) {
+                graph.Connect(a, lo + random.Below(size));
+            }
+        }
+    }
+    std::set<int> cut_ends;
+    while (cut_ends.size() < 6) {
+        int a = random.Below(n / 2), b = n / 2 + random.Below(n - n / 2);
+        if (!cut_ends.contains(a) && !cut_ends.contains(b)) {
+            graph.Connect(a, b);
+            cut_ends.insert(a);
+            cut_ends.insert(b);
+        }
+    }
+
+    // Every edge is listed once, on the line of either end.
+    std::vector<std::string> names = MakeNames(n, 3, random);
+    std::vector<std::vector<int>> lists(n);
+    for (auto [a, b] : graph.Edges()) {
+        if (random.Chance(0.5)) {
+            std::swap(a, b);
+        }
+        lists[a].push_back(b);
+    }
+    std::vector<std::string> lines;
+    for (int a = 0; a < n; a++) {
+        if (lists[a].empty()) {
+            continue;
+        }
+        random.Shuffle(lists[a]);
+        std::string line = names[a] + ":";
+        for (int b : lists[a]) {
+            line += " " + names[b];
+        }
+        lines.push_back(line);
+    }
+    random.Shuffle(lines);
+    Print(lines);
+}
+
+void Network(Options& options, Random& random) {
+    int n = options.GetInt("size", 520);
+    int degree = options.GetInt("degree", 13);
+    int clique = options.GetInt("clique", 13);
+    options.CheckAllUsed();
+    assert(clique >= 1 && clique <= n && clique <= degree + 1 && degree < n - 1);
+
+    Graph graph(n);
+    std::vector<int> nodes(n);
+    for (int a = 0; a < n; a++) {
+        nodes[a] = a;
+    }
+    random.Shuffle(nodes);
+    for (int x = 0; x < clique; x++) {
+        for (int y = x + 1; y < clique; y++) {
+            graph.Connect(nodes[x], nodes[y]);
+        }
+    }
+    // Solutions may take time exponential in the degree, so it's bounded:
+    // nodes are connected at random while they have room, until the few
+    // that are left can't be paired anymore.
+    std::vector<int> open;
+    for (int a = 0; a < n; a++) {
+        if (graph.Degree(a) < degree) {
+            open.push_back(a);
+        }
+    }
+    for (int failures = 0; open.size() >= 2 && failures < 1000;) {
+        int x = random.Below(open.size()), y = random.Below(open.size());
+        if (!graph.Connect(open[x], open[y])) {
+            failures++;
+            continue;
+        }
+        failures = 0;
+        for (int z : {std::max(x, y), std::min(x, y)}) {
+            if (graph.Degree(open[z]) == degree) {
+                open[z] = open.back();
+                open.pop_back();
+            }
+        }
+    }
+
+    std::vector<std::string> names = MakeNames(n, 2, random);
+    std::vector<std::string> lines;
+    for (auto [a, b] : graph.Edges()) {
+        if (random.Chance(0.5)) {
+            std::swap(a, b);
+        }
+        lines.push_back(names[a] + "-" + names[b]);
+    }
+    random.Shuffle(lines);
+    Print(lines);
+}
+
+void Sensors(Options& options, Random& random) {
+    int n = options.GetInt("size", 40);
+    options.CheckAllUsed();
+    assert(n >= 4);
+
+    // The search area of 2022/15, and the point that stays uncovered.
+    const long long kMax = 4000000;
+    long long px = random.Between(kMax / 4, kMax * 3 / 4);
+    long long py = random.Between(kMax / 4, kMax * 3 / 4);
+    std::cerr << "Distress beacon at x=" << px << ", y=" << py << std::endl;
+
+    // A sensor reaching right up to (px, py) covers every point of the area
+    // that is closer to it than (px, py). From a corner, that is the whole
+    // quadrant of the area on the corner's side, except (px, py) itself. So
+    // the sensors in the corners cover everything, and the others get
+    // smaller, random ranges.
+    std::vector<std::string> lines;
+    for (int k = 0; k < n; k++) {
+        long long x, y, distance;
+        do {
+            x = (k < 4) ? (k % 2) * kMax : random.Between(0, kMax);
+            y = (k < 4) ? (k / 2) * kMax : random.Between(0, kMax);
+            distance = std::abs(x - px) + std::abs(y - py);
+        } while (distance < 2);
+        long long range = distance - 1;
+        if (k >= 4) {
+            range = std::min(range, random.Between(kMax / 16, kMax / 4));
+        }
+
+        long long dx = random.Between(0, range), dy = range - dx;
+        long long bx = x + (random.Chance(0.5) ? dx : -dx);
+        long long by = y + (random.Chance(0.5) ? dy : -dy);
+        lines.push_back("Sensor at x=" + std::to_string(x) + ", y=" + std::to_string(y) +
+                        ": closest beacon is at x=" + std::to_string(bx) +
+                        ", y=" + std::to_string(by));
+    }
+    random.Shuffle(lines);
+    Print(lines);
+}
+
+void Numbers(Options& options, Random& random) {
+    int n = options.GetInt("size", 1000);
+    int columns = options.GetInt("columns", 2);
+    long long max = options.GetInt("max", 99999);
+    options.CheckAllUsed();
+    assert(columns >= 1 && max >= 1);
+    for (int k = 0; k < n; k++) {
+        for (int c = 0; c < columns; c++) {
+            std::cout << (c > 0 ? "   " : "") << random.Between(1, max);
+        }
+        std::cout << "\n";
+    }
+}
+
+int Usage() {
+    std::cerr << "Usage: generate maze|track|digits|wires|network|sensors|numbers [--size N] "
+                 "[--seed S] [OPTIONS]"
+              << std::endl;
+    return 2;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        return Usage();
+    }
+    std::string kind = argv[1];
+    Options options(argc - 2, argv + 2);
+    Random random(options.GetInt("seed", 1));
+
+    const std::map<std::string, void (*)(Options&, Random&)> kKinds = {
+        {"maze", Maze},         {"track", Track},     {"digits", Digits},   {"wires", Wires},
+        {"network", Network},   {"sensors", Sensors}, {"numbers", Numbers},
+    };
+    auto it = kKinds.find(kind);
+    if (it == kKinds.end()) {
+        return Usage();
+    }
+    it->second(options, random);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,345 @@
+// Microbenchmarks for the headers in include/: graph searches on grids,
+// parsing, hashing of coordinates, transposition and rational arithmetic.
+// Workloads are synthetic and generated from fixed seeds, so numbers from
+// different builds are comparable.
+//
+// Usage:
+//
+// microbench [--size N] [--reps R] [--perf] [NAME_PREFIX...]
+//
+// N is the side of the grids and matrices (default 1024, up to 4096). Every
+// benchmark runs once to warm up and then R times (default 5). The output
+// has one line per benchmark with fixed columns: name, operations per
+// repetition, median and best ns/op, and millions of operations per second,
+// plus MB/s for the ones that consume text.
+//
+// With --perf, hardware counters are added where available (see
+// perf_counters.h): instructions per cycle, and L1D, LLC, branch and dTLB
+// misses per operation.
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "collections.h"
+#include "graph_search.h"
+#include "grid.h"
+#include "numbers.h"
+#include "parse.h"
+#include "perf_counters.h"
+#include "random.h"
+
+// Depth of the recursion in DFS() grows with the number of nodes, so DFS
+// runs on grids of at most this side to fit into a default-sized stack.
+const int kMaxDFSSide = 128;
+
+struct Benchmark {
+    std::string name;
+    // Does the work once and returns the number of operations done.
+    std::function<long long()> run;
+    // Bytes consumed per run, for throughput. 0 if not applicable.
+    long long bytes = 0;
+};
+
+// Results go here so that the compiler can't drop the work.
+volatile long long sink = 0;
+
+// Grid with about 25% walls ('#') and a free corner at (0, 0).
+std::vector<std::string> MakeMaze(int side, uint64_t seed) {
+    Random random(seed);
+    std::vector<std::string> maze(side, std::string(side, '.'));
+    for (std::string& row : maze) {
+        for (char& c : row) {
+            if (random.Below(4) == 0) {
+                c = '#';
+            }
+        }
+    }
+    maze[0][0] = '.';
+    return maze;
+}
+
+// Calls f(next) for the free neighbors of c.
+template <typename F>
+void ForEachNeighbor(const std::vector<std::string>& maze, const Coord& c, F&& f) {
+    int side = maze.size();
+    for (const Coord& dir : {kNorth, kSouth, kWest, kEast}) {
+        Coord next = c + dir;
+        if (next.i >= 0 && next.i < side && next.j >= 0 && next.j < side &&
+            maze[next.i][next.j] != '#') {
+            f(next);
+        }
+    }
+}
+
+// Lines like "Game 17: 3 red, 40 blue, 5 green", about `bytes` in total.
+std::vector<std::string> MakeLines(long long bytes, uint64_t seed) {
+    Random random(seed);
+    std::vector<std::string> lines;
+    long long total = 0;
+    while (total < bytes) {
+        std::string line = "Game " + std::to_string(lines.size() + 1) + ": ";
+        int n = 5 + random.Below(20);
+        for (int k = 0; k < n; k++) {
+            line += std::to_string(random.Below(1000000)) + (k + 1 < n ? ", " : "");
+        }
+        total += line.size() + 1;
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+std::vector<Benchmark> MakeBenchmarks(int side) {
+    std::vector<Benchmark> result;
+    auto maze = std::make_shared<std::vector<std::string>>(MakeMaze(side, 1));
+
+    result.push_back({"bfs_grid", [=]() {
+        auto depths = BFSFrom(Coord(0, 0), [&](auto& search, const Coord& c) {
+            ForEachNeighbor(*maze, c, [&](const Coord& next) { search.Look(next); });
+        });
+        sink = sink + depths.size();
+        return (long long)depths.size();
+    }});
+
+    int dfs_side = std::min(side, kMaxDFSSide);
+    auto small_maze = std::make_shared<std::vector<std::string>>(MakeMaze(dfs_side, 2));
+    int dfs_repeats = std::max(1, (side / dfs_side) * (side / dfs_side));
+    result.push_back({"dfs_grid", [=]() {
+        long long nodes = 0;
+        for (int r = 0; r < dfs_repeats; r++) {
+            auto times = DFSFrom(Coord(0, 0), [&](auto& search, const Coord& c) {
+                ForEachNeighbor(*small_maze, c, [&](const Coord& next) { search.Look(next); });
+            });
+            nodes += times.enter_times.size();
+        }
+        sink = sink + nodes;
+        return nodes;
+    }});
+
+    auto dijkstra = [=]<typename PQueue>() {
+        auto dists = DijkstraFrom<Coord, int, std::hash<Coord>, PQueue>(
+            Coord(0, 0), 0, [&](auto& search, const Coord& c, int dist) {
+                ForEachNeighbor(*maze, c, [&](const Coord& next) {
+                    search.Look(next, dist + 1 + (next.i * 7 + next.j * 13) % 9);
+                });
+            });
+        sink = sink + dists.size();
+        return (long long)dists.size();
+    };
+    result.push_back({"dijkstra_heap", [=]() {
+        return dijkstra.template operator()<HeapQueue<Coord, int>>();
+    }});
+    result.push_back({"dijkstra_short", [=]() {
+        return dijkstra.template operator()<ShortQueue<Coord>>();
+    }});
+
+    // About 4 bytes of text per grid cell, so 4 MB for the default size.
+    auto lines = std::make_shared<std::vector<std::string>>(MakeLines(4LL * side * side, 3));
+    auto text = std::make_shared<std::string>();
+    for (const std::string& line : *lines) {
+        *text += line + "\n";
+    }
+    long long text_bytes = text->size();
+
+    result.push_back({"split_lines", [=]() {
+        std::vector<std::string> parts = Split(*text, "\n");
+        sink = sink + parts.size();
+        return (long long)parts.size();
+    }, text_bytes});
+    result.push_back({"splitn", [=]() {
+        long long total = 0;
+        for (const std::string& line : *lines) {
+            auto [game, rest] = SplitN(line, ": ");
+            total += game.size() + rest.size();
+        }
+        sink = sink + total;
+        return (long long)lines->size();
+    }, text_bytes});
+    result.push_back({"parse_vector", [=]() {
+        long long total = 0;
+        for (const std::string& line : *lines) {
+            auto [_, rest] = SplitN(line, ": ");
+            total += ParseVector<long long>(rest).size();
+        }
+        sink = sink + total;
+        return total;
+    }, text_bytes});
+
+    result.push_back({"hash_coord_insert", [=]() {
+        std::unordered_set<Coord> set;
+        for (int i = 0; i < side; i++) {
+            for (int j = 0; j < side; j++) {
+                set.insert(Coord(i, j));
+            }
+        }
+        sink = sink + set.size();
+        return (long long)side * side;
+    }});
+    auto coords = std::make_shared<std::unordered_set<Coord>>();
+    for (int i = 0; i < side; i += 2) {
+        for (int j = 0; j < side; j++) {
+            coords->insert(Coord(i, j));
+        }
+    }
+    result.push_back({"hash_coord_lookup", [=]() {
+        long long found = 0;
+        for (int i = 0; i < side; i++) {
+            for (int j = 0; j < side; j++) {
+                found += coords->contains(Coord(i, j));
+            }
+        }
+        sink = sink + found;
+        return (long long)side * side;
+    }});
+
+    result.push_back({"transpose_chars", [=]() {
+        std::vector<std::string> t = Transpose(*maze);
+        sink = sink + t[side - 1][0];
+        return (long long)side * side;
+    }});
+    auto numbers = std::make_shared<std::vector<std::vector<int>>>(side, std::vector<int>(side));
+    for (int i = 0; i < side; i++) {
+        for (int j = 0; j < side; j++) {
+            (*numbers)[i][j] = i * side + j;
+        }
+    }
+    result.push_back({"transpose_ints", [=]() {
+        std::vector<std::vector<int>> t = Transpose(*numbers);
+        sink = sink + t[side - 1][0];
+        return (long long)side * side;
+    }});
+
+    // Four operations per iteration on small fractions, which is what puzzle
+    // solutions mostly do.
+    auto rational = [=]<typename R>() {
+        long long n = (long long)side * side / 4;
+        long long total = 0;
+        for (long long k = 0; k < n; k++) {
+            R x = R(k % 97 + 1) / R(k % 89 + 1);
+            R y = R(k % 13 + 1) / R(k % 17 + 1);
+            total += (x * y + x / y - x).Num();
+        }
+        sink = sink + total;
+        return 4 * n;
+    };
+    result.push_back({"rational_ll", [=]() {
+        return rational.template operator()<LLRat>();
+    }});
+    result.push_back({"rational_ll_lazy", [=]() {
+        return rational.template operator()<Rational<long long, true>>();
+    }});
+    return result;
+}
+
+const PerfEvent kMissEvents[] = {PerfEvent::kL1DMisses, PerfEvent::kLLCMisses,
+                                  PerfEvent::kBranchMisses, PerfEvent::kDTLBMisses};
+
+// Prints x in a column, or "-" if it's missing.
+void PrintColumn(int width, std::optional<double> x) {
+    std::cout << std::setw(width);
+    if (x.has_value()) {
+        std::cout << *x;
+    } else {
+        std::cout << "-";
+    }
+}
+
+// perf is null unless --perf is given and there are counters.
+void Run(const Benchmark& b, int reps, const PerfCounters* perf) {
+    b.run();
+    std::vector<double> ns;
+    long long ops = 0;
+    PerfSample before;
+    if (perf != nullptr) {
+        before = perf->Read();
+    }
+    for (int r = 0; r < reps; r++) {
+        auto start = std::chrono::steady_clock::now();
+        ops = b.run();
+        auto finish = std::chrono::steady_clock::now();
+        ns.push_back(std::chrono::duration<double, std::nano>(finish - start).count());
+    }
+    PerfSample counts;
+    if (perf != nullptr) {
+        counts = perf->Read() - before;
+    }
+    std::sort(ns.begin(), ns.end());
+    double median = ns[ns.size() / 2];
+
+    std::cout << std::left << std::setw(20) << b.name << std::right << std::setw(12) << ops
+              << std::fixed << std::setprecision(2) << std::setw(12) << median / ops
+              << std::setw(12) << ns[0] / ops << std::setw(12) << ops / median * 1000;
+    if (b.bytes > 0) {
+        std::cout << std::setw(12) << b.bytes / median * 1000;
+    } else {
+        std::cout << std::setw(12) << "-";
+    }
+    if (perf != nullptr) {
+        PrintColumn(8, counts.Ipc());
+        for (PerfEvent event : kMissEvents) {
+            std::optional<double> count = counts.Get(event);
+            PrintColumn(10, count.has_value() ? std::optional<double>(*count / ops / reps)
+                                              : std::nullopt);
+        }
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int side = 1024, reps = 5;
+    bool use_perf = false;
+    std::vector<std::string> prefixes;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) {
+            side = std::stoi(argv[++i]);
+        } else if (arg == "--reps" && i + 1 < argc) {
+            reps = std::stoi(argv[++i]);
+        } else if (arg == "--perf") {
+            use_perf = true;
+        } else {
+            prefixes.push_back(arg);
+        }
+    }
+    assert(side >= 2 && side <= 4096);
+    assert(reps >= 1);
+
+    PerfCounters counters;
+    const PerfCounters* perf = nullptr;
+    if (use_perf) {
+        if (counters.Available()) {
+            perf = &counters;
+        } else {
+            std::cerr << "No hardware counters available, ignoring --perf" << std::endl;
+        }
+    }
+
+    std::cout << "# size=" << side << " reps=" << reps << std::endl;
+    std::cout << std::left << std::setw(20) << "name" << std::right << std::setw(12) << "ops"
+              << std::setw(12) << "ns/op" << std::setw(12) << "best ns/op" << std::setw(12)
+              << "Mops/s" << std::setw(12) << "MB/s";
+    if (perf != nullptr) {
+        std::cout << std::setw(8) << "IPC" << std::setw(10) << "L1D/op" << std::setw(10)
+                  << "LLC/op" << std::setw(10) << "br/op" << std::setw(10) << "dTLB/op";
+    }
+    std::cout << std::endl;
+    for (const Benchmark& b : MakeBenchmarks(side)) {
+        bool selected = prefixes.empty() ||
+                        std::any_of(prefixes.begin(), prefixes.end(), [&](const std::string& p) {
+                            return b.name.starts_with(p);
+                        });
+        if (selected) {
+            Run(b, reps, perf);
+        }
+    }
+    return 0;
+}
\ No newline at end of file
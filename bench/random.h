@@ -0,0 +1,47 @@
+#ifndef __AOC_BENCH_RANDOM_H__
+#define __AOC_BENCH_RANDOM_H__
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Deterministic generator, so that workloads don't depend on the platform.
+// Standard distributions and std::shuffle() are implementation-defined, so
+// everything is derived from Next() here.
+class Random {
+   public:
+    explicit Random(uint64_t seed) : state_(seed) {}
+
+    // 31 random bits.
+    uint32_t Next() {
+        state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state_ >> 33;
+    }
+
+    int Below(int bound) {
+        return Next() % bound;
+    }
+
+    // Uniform in [lo, hi].
+    long long Between(long long lo, long long hi) {
+        uint64_t x = ((uint64_t)Next() << 31) | Next();
+        return lo + (long long)(x % (uint64_t)(hi - lo + 1));
+    }
+
+    // True with probability p.
+    bool Chance(double p) {
+        return Next() < p * 2147483648.0;
+    }
+
+    template <typename T>
+    void Shuffle(std::vector<T>& v) {
+        for (int i = (int)v.size() - 1; i > 0; i--) {
+            std::swap(v[i], v[Below(i + 1)]);
+        }
+    }
+
+   private:
+    uint64_t state_;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,173 @@
+#ifndef __AOC_ARENA_H__
+#define __AOC_ARENA_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// Memory resource that hands out memory by bumping a pointer and never frees
+// individual blocks. Everything is released at once by Reset(), which keeps
+// the memory for reuse, or by the destructor.
+//
+// Meant for the many small nodes of maps and lists that live until the end of
+// a computation, e.g. the bookkeeping of a search that is repeated many times:
+//
+// MonotonicArena arena;
+// for (...) {
+//     arena.Reset();
+//     std::pmr::unordered_map<Node, int> depth(&arena);
+//     auto result = BFSFrom(start, visit, std::pmr::polymorphic_allocator<Node>(&arena));
+// }
+//
+// Everything allocated from the arena must be gone before Reset(). Not
+// thread-safe.
+class MonotonicArena : public std::pmr::memory_resource {
+   public:
+    // Memory is requested in chunks, starting from chunk_size and doubling.
+    // With huge_pages, chunks are aligned to 2 MB, and on Linux the kernel is
+    // asked to back them with transparent huge pages, which saves TLB misses
+    // when the arena is large.
+    explicit MonotonicArena(size_t chunk_size = 1 << 16, bool huge_pages = false)
+        : next_chunk_size_(std::max<size_t>(chunk_size, 64)), huge_pages_(huge_pages) {
+        if (huge_pages_) {
+            next_chunk_size_ = RoundUp(next_chunk_size_, kHugePageSize);
+        }
+    }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    ~MonotonicArena() {
+        FreeChunks();
+    }
+
+    // Makes all memory available again. If the previous round needed several
+    // chunks, they are replaced by a single one as big as all of them
+    // together, so that the next round of the same size is contiguous.
+    void Reset() {
+        if (chunks_.size() > 1) {
+            size_t total = BytesReserved();
+            FreeChunks();
+            next_chunk_size_ = total;
+            AddChunk(0);
+        }
+        current_ = 0;
+        used_before_current_ = 0;
+        if (!chunks_.empty()) {
+            cursor_ = chunks_[0].begin;
+        }
+    }
+
+    // Bytes handed out since the last Reset(), including alignment padding.
+    size_t BytesUsed() const {
+        if (chunks_.empty()) {
+            return 0;
+        }
+        return used_before_current_ + (cursor_ - chunks_[current_].begin);
+    }
+
+    // Bytes obtained from the system.
+    size_t BytesReserved() const {
+        size_t total = 0;
+        for (const Chunk& chunk : chunks_) {
+            total += chunk.size;
+        }
+        return total;
+    }
+
+   private:
+    static constexpr size_t kHugePageSize = 2 << 20;
+
+    struct Chunk {
+        std::byte* begin;
+        size_t size;
+    };
+
+    static size_t RoundUp(size_t x, size_t alignment) {
+        return (x + alignment - 1) / alignment * alignment;
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        while (true) {
+            if (!chunks_.empty()) {
+                const Chunk& chunk = chunks_[current_];
+                // Chunks are only as aligned as operator new makes them, so align the
+                // address rather than the offset.
+                uintptr_t begin = reinterpret_cast<uintptr_t>(chunk.begin);
+                size_t offset = RoundUp(reinterpret_cast<uintptr_t>(cursor_), alignment) - begin;
+                if (offset + bytes <= chunk.size) {
+                    cursor_ = chunk.begin + offset + bytes;
+                    return chunk.begin + offset;
+                }
+            }
+            // Move on to the next chunk, which is either left from before the
+            // last Reset() or new.
+            if (current_ + 1 < chunks_.size()) {
+                used_before_current_ += chunks_[current_].size;
+                current_++;
+                cursor_ = chunks_[current_].begin;
+            } else {
+                AddChunk(bytes + alignment);
+            }
+        }
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    // Appends a chunk that can hold at least min_size bytes and makes it
+    // current.
+    void AddChunk(size_t min_size) {
+        size_t size = std::max(next_chunk_size_, min_size);
+        std::byte* begin;
+        if (huge_pages_) {
+            size = RoundUp(size, kHugePageSize);
+            begin = static_cast<std::byte*>(
+                ::operator new(size, std::align_val_t(kHugePageSize)));
+#ifdef __linux__
+            madvise(begin, size, MADV_HUGEPAGE);
+#endif
+        } else {
+            begin = static_cast<std::byte*>(::operator new(size));
+        }
+
+        if (!chunks_.empty()) {
+            used_before_current_ += chunks_[current_].size;
+        }
+        chunks_.push_back(Chunk{begin, size});
+        current_ = chunks_.size() - 1;
+        cursor_ = begin;
+        next_chunk_size_ = size * 2;
+    }
+
+    void FreeChunks() {
+        for (const Chunk& chunk : chunks_) {
+            if (huge_pages_) {
+                ::operator delete(chunk.begin, std::align_val_t(kHugePageSize));
+            } else {
+                ::operator delete(chunk.begin);
+            }
+        }
+        chunks_.clear();
+    }
+
+    std::vector<Chunk> chunks_;
+    size_t current_ = 0;
+    std::byte* cursor_ = nullptr;
+    // Sizes of the chunks before the current one, for BytesUsed().
+    size_t used_before_current_ = 0;
+    size_t next_chunk_size_;
+    bool huge_pages_;
+};
+
+#endif
\ No newline at end of file
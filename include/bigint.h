@@ -0,0 +1,572 @@
+#ifndef __AOC_BIGINT_H__
+#define __AOC_BIGINT_H__
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cctype>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "collections.h"
+#include "numbers.h"
+
+// Arbitrary-precision signed integer.
+//
+// Values that fit into __int128 are stored inline and computed on with
+// native instructions, falling back to the general case on overflow. Only
+// bigger values allocate. Big values are sign and magnitude, the magnitude
+// being base-2^32 limbs with the least significant first. Big products use
+// Karatsuba multiplication.
+//
+// Division and remainder round towards zero, like for built-in integers.
+// Works with Rational (see BigRat), ParseVector() and iostreams.
+class BigInt {
+   public:
+    BigInt() : value_(0) {}
+
+    template <typename U>
+    BigInt(U x)
+        requires std::integral<U>
+    {
+        if (std::is_signed_v<U> || (unsigned __int128)x <= (unsigned __int128)kSmallMax) {
+            value_ = x;
+        } else {
+            *this = FromMagnitude(false, ToMagnitude(x));
+        }
+    }
+
+    // Parses an optional sign followed by decimal digits. Dies on anything
+    // else.
+    explicit BigInt(std::string_view s) : BigInt() {
+        bool negative = false;
+        if (!s.empty() && (s[0] == '-' || s[0] == '+')) {
+            negative = (s[0] == '-');
+            s.remove_prefix(1);
+        }
+        assert(!s.empty());
+
+        // Consume 9 digits at a time, starting with the leftover ones.
+        Magnitude mag;
+        size_t chunk = (s.size() - 1) % 9 + 1;
+        for (size_t pos = 0; pos < s.size(); pos += chunk, chunk = 9) {
+            uint32_t digits = 0;
+            for (char c : s.substr(pos, chunk)) {
+                assert(std::isdigit(c));
+                digits = digits * 10 + (c - '0');
+            }
+            MulAddSmall(mag, (pos == 0) ? 1 : 1000000000, digits);
+        }
+        *this = FromMagnitude(negative, std::move(mag));
+    }
+
+    BigInt(const BigInt&) = default;
+    BigInt& operator=(const BigInt&) = default;
+    BigInt(BigInt&&) = default;
+    BigInt& operator=(BigInt&&) = default;
+
+    // True if the value is stored inline, i.e. it fits into __int128.
+    bool IsSmall() const {
+        return small_;
+    }
+
+    std::string ToString() const {
+        if (small_) {
+            std::ostringstream oss;
+            oss << value_;
+            return oss.str();
+        }
+
+        // Peel off 9 digits at a time, from the lowest ones.
+        Magnitude mag = mag_;
+        std::string result;
+        while (!mag.empty()) {
+            uint32_t digits = DivModSmall(mag, 1000000000);
+            for (int k = 0; k < 9 && !(mag.empty() && digits == 0); k++) {
+                result.push_back('0' + digits % 10);
+                digits /= 10;
+            }
+        }
+        if (negative_) {
+            result.push_back('-');
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+
+    // Conversions to built-in integers keep the lowest bits, like casts
+    // between built-in integers do.
+    template <typename U>
+    explicit operator U() const
+        requires std::integral<U>
+    {
+        if (small_) {
+            return static_cast<U>(value_);
+        }
+        unsigned __int128 low = 0;
+        for (int i = std::min<int>(mag_.size(), 4) - 1; i >= 0; i--) {
+            low = (low << 32) | mag_[i];
+        }
+        return static_cast<U>(negative_ ? -low : low);
+    }
+
+    template <typename U>
+    explicit operator U() const
+        requires std::floating_point<U>
+    {
+        if (small_) {
+            return static_cast<U>(value_);
+        }
+        U result = 0;
+        for (int i = mag_.size() - 1; i >= 0; i--) {
+            result = result * U(4294967296.0) + mag_[i];
+        }
+        return negative_ ? -result : result;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const BigInt& x) {
+        return out << x.ToString();
+    }
+
+    // Reads an optional sign followed by decimal digits, skipping leading
+    // whitespace. Sets failbit if there are no digits.
+    friend std::istream& operator>>(std::istream& in, BigInt& x) {
+        std::istream::sentry sentry(in);
+        if (!sentry) {
+            return in;
+        }
+        std::string s;
+        if (in.peek() == '-' || in.peek() == '+') {
+            s.push_back(in.get());
+        }
+        while (std::isdigit(in.peek())) {
+            s.push_back(in.get());
+        }
+        if (s.empty() || !std::isdigit(s.back())) {
+            in.setstate(std::ios::failbit);
+        } else {
+            x = BigInt(s);
+        }
+        return in;
+    }
+
+    // Comparison.
+
+    friend bool operator==(const BigInt& a, const BigInt& b) {
+        if (a.small_ || b.small_) {
+            return a.small_ && b.small_ && a.value_ == b.value_;
+        }
+        return a.negative_ == b.negative_ && a.mag_ == b.mag_;
+    }
+
+    friend std::strong_ordering operator<=>(const BigInt& a, const BigInt& b) {
+        if (a.small_ && b.small_) {
+            return a.value_ <=> b.value_;
+        }
+        // Big values are greater in absolute value than small ones.
+        if (a.small_) {
+            return b.negative_ ? std::strong_ordering::greater : std::strong_ordering::less;
+        }
+        if (b.small_) {
+            return a.negative_ ? std::strong_ordering::less : std::strong_ordering::greater;
+        }
+        if (a.negative_ != b.negative_) {
+            return a.negative_ ? std::strong_ordering::less : std::strong_ordering::greater;
+        }
+        std::strong_ordering c = Compare(a.mag_, b.mag_);
+        return a.negative_ ? (0 <=> c) : c;
+    }
+
+    // Arithmetic. The operators are friends, so that built-in integers on
+    // either side get converted.
+
+    BigInt operator-() const {
+        if (small_ && value_ != kSmallMin) {
+            return BigInt(-value_);
+        }
+        return FromMagnitude(!Negative(), Abs());
+    }
+
+    friend BigInt operator+(const BigInt& a, const BigInt& b) {
+        __int128 result;
+        if (a.small_ && b.small_ && !__builtin_add_overflow(a.value_, b.value_, &result)) {
+            return BigInt(result);
+        }
+        return AddSigned(a.Negative(), a.Abs(), b.Negative(), b.Abs());
+    }
+
+    friend BigInt operator-(const BigInt& a, const BigInt& b) {
+        __int128 result;
+        if (a.small_ && b.small_ && !__builtin_sub_overflow(a.value_, b.value_, &result)) {
+            return BigInt(result);
+        }
+        return AddSigned(a.Negative(), a.Abs(), !b.Negative(), b.Abs());
+    }
+
+    friend BigInt operator*(const BigInt& a, const BigInt& b) {
+        __int128 result;
+        if (a.small_ && b.small_ && MulSmall(a.value_, b.value_, &result)) {
+            return BigInt(result);
+        }
+        return FromMagnitude(a.Negative() != b.Negative(), Multiply(a.Abs(), b.Abs()));
+    }
+
+    friend BigInt operator/(const BigInt& a, const BigInt& b) {
+        assert(b != 0);
+        if (a.small_ && b.small_ && !(a.value_ == kSmallMin && b.value_ == -1)) {
+            return BigInt(a.value_ / b.value_);
+        }
+        auto [q, r] = DivMod(a.Abs(), b.Abs());
+        return FromMagnitude(a.Negative() != b.Negative(), std::move(q));
+    }
+
+    friend BigInt operator%(const BigInt& a, const BigInt& b) {
+        assert(b != 0);
+        if (a.small_ && b.small_) {
+            return (b.value_ == -1) ? BigInt(0) : BigInt(a.value_ % b.value_);
+        }
+        auto [q, r] = DivMod(a.Abs(), b.Abs());
+        return FromMagnitude(a.Negative(), std::move(r));
+    }
+
+    BigInt& operator+=(const BigInt& other) {
+        return *this = *this + other;
+    }
+
+    BigInt& operator-=(const BigInt& other) {
+        return *this = *this - other;
+    }
+
+    BigInt& operator*=(const BigInt& other) {
+        return *this = *this * other;
+    }
+
+    BigInt& operator/=(const BigInt& other) {
+        return *this = *this / other;
+    }
+
+    BigInt& operator%=(const BigInt& other) {
+        return *this = *this % other;
+    }
+
+    friend struct std::hash<BigInt>;
+
+   private:
+    // Limbs in base 2^32, least significant first, without leading zeros.
+    using Magnitude = std::vector<uint32_t>;
+
+    static constexpr __int128 kSmallMax = ~(unsigned __int128)0 >> 1;
+    static constexpr __int128 kSmallMin = -kSmallMax - 1;
+
+    // Products of operands shorter than this many limbs are computed with
+    // the schoolbook method.
+    static constexpr int kKaratsubaThreshold = 32;
+
+    bool Negative() const {
+        return small_ ? (value_ < 0) : negative_;
+    }
+
+    Magnitude Abs() const {
+        if (!small_) {
+            return mag_;
+        }
+        unsigned __int128 x = value_;
+        return ToMagnitude(value_ < 0 ? -x : x);
+    }
+
+    // Signed __builtin_mul_overflow() on __int128 traps under -ftrapv, so
+    // this multiplies the absolute values instead.
+    static bool MulSmall(__int128 a, __int128 b, __int128* result) {
+        unsigned __int128 ua = a, ub = b, product;
+        if (__builtin_mul_overflow(a < 0 ? -ua : ua, b < 0 ? -ub : ub, &product)) {
+            return false;
+        }
+        bool negative = (a < 0) != (b < 0);
+        if (product > (unsigned __int128)kSmallMax + negative) {
+            return false;
+        }
+        *result = negative ? (__int128)-product : (__int128)product;
+        return true;
+    }
+
+    static Magnitude ToMagnitude(unsigned __int128 x) {
+        Magnitude result;
+        for (; x != 0; x >>= 32) {
+            result.push_back((uint32_t)x);
+        }
+        return result;
+    }
+
+    // Builds a value, storing it inline if it fits.
+    static BigInt FromMagnitude(bool negative, Magnitude mag) {
+        Trim(mag);
+        if (mag.size() <= 4) {
+            unsigned __int128 x = 0;
+            for (int i = mag.size() - 1; i >= 0; i--) {
+                x = (x << 32) | mag[i];
+            }
+            if (x <= (unsigned __int128)kSmallMax) {
+                return BigInt(negative ? -(__int128)x : (__int128)x);
+            }
+            if (negative && x == (unsigned __int128)kSmallMax + 1) {
+                return BigInt(kSmallMin);
+            }
+        }
+        BigInt result;
+        result.small_ = false;
+        result.value_ = 0;
+        result.negative_ = negative;
+        result.mag_ = std::move(mag);
+        return result;
+    }
+
+    static void Trim(Magnitude& mag) {
+        while (!mag.empty() && mag.back() == 0) {
+            mag.pop_back();
+        }
+    }
+
+    static std::strong_ordering Compare(const Magnitude& a, const Magnitude& b) {
+        if (a.size() != b.size()) {
+            return a.size() <=> b.size();
+        }
+        for (int i = a.size() - 1; i >= 0; i--) {
+            if (a[i] != b[i]) {
+                return a[i] <=> b[i];
+            }
+        }
+        return std::strong_ordering::equal;
+    }
+
+    // Adds b * 2^(32 * shift) to a.
+    static void AddInto(Magnitude& a, const Magnitude& b, size_t shift = 0) {
+        if (a.size() < b.size() + shift) {
+            a.resize(b.size() + shift, 0);
+        }
+        uint64_t carry = 0;
+        size_t i = 0;
+        for (; i < b.size(); i++) {
+            carry += (uint64_t)a[i + shift] + b[i];
+            a[i + shift] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        for (i += shift; carry != 0; i++) {
+            if (i == a.size()) {
+                a.push_back(0);
+            }
+            carry += a[i];
+            a[i] = (uint32_t)carry;
+            carry >>= 32;
+        }
+    }
+
+    // Subtracts b from a. Requires a >= b.
+    static void SubInto(Magnitude& a, const Magnitude& b) {
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < a.size(); i++) {
+            uint64_t sub = borrow + (i < b.size() ? b[i] : 0);
+            if (sub == 0 && i >= b.size()) {
+                break;
+            }
+            borrow = (a[i] < sub) ? 1 : 0;
+            a[i] = (uint32_t)((uint64_t)a[i] + (borrow << 32) - sub);
+        }
+        assert(borrow == 0);
+        Trim(a);
+    }
+
+    static BigInt AddSigned(bool a_negative, Magnitude a, bool b_negative, Magnitude b) {
+        if (a_negative == b_negative) {
+            AddInto(a, b);
+            return FromMagnitude(a_negative, std::move(a));
+        }
+        if (Compare(a, b) >= 0) {
+            SubInto(a, b);
+            return FromMagnitude(a_negative, std::move(a));
+        }
+        SubInto(b, a);
+        return FromMagnitude(b_negative, std::move(b));
+    }
+
+    static Magnitude Schoolbook(const Magnitude& a, const Magnitude& b) {
+        if (a.empty() || b.empty()) {
+            return {};
+        }
+        Magnitude result(a.size() + b.size(), 0);
+        for (size_t i = 0; i < a.size(); i++) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < b.size(); j++) {
+                carry += (uint64_t)a[i] * b[j] + result[i + j];
+                result[i + j] = (uint32_t)carry;
+                carry >>= 32;
+            }
+            result[i + b.size()] = (uint32_t)carry;
+        }
+        Trim(result);
+        return result;
+    }
+
+    // Karatsuba: with a = a1 * B + a0 and b = b1 * B + b0, the product is
+    // z2 * B^2 + z1 * B + z0 where z1 = (a0 + a1) * (b0 + b1) - z2 - z0.
+    static Magnitude Multiply(const Magnitude& a, const Magnitude& b) {
+        if (std::min(a.size(), b.size()) < kKaratsubaThreshold) {
+            return Schoolbook(a, b);
+        }
+        size_t half = std::max(a.size(), b.size()) / 2;
+        auto split = [half](const Magnitude& x) {
+            size_t mid = std::min(half, x.size());
+            Magnitude low(x.begin(), x.begin() + mid), high(x.begin() + mid, x.end());
+            Trim(low);
+            return std::make_pair(low, high);
+        };
+        auto [a0, a1] = split(a);
+        auto [b0, b1] = split(b);
+
+        Magnitude z0 = Multiply(a0, b0);
+        Magnitude z2 = Multiply(a1, b1);
+        AddInto(a0, a1);
+        AddInto(b0, b1);
+        Magnitude z1 = Multiply(a0, b0);
+        SubInto(z1, z0);
+        SubInto(z1, z2);
+
+        Magnitude result = std::move(z0);
+        AddInto(result, z1, half);
+        AddInto(result, z2, 2 * half);
+        Trim(result);
+        return result;
+    }
+
+    // mag = mag * factor + addend.
+    static void MulAddSmall(Magnitude& mag, uint32_t factor, uint32_t addend) {
+        uint64_t carry = addend;
+        for (uint32_t& limb : mag) {
+            carry += (uint64_t)limb * factor;
+            limb = (uint32_t)carry;
+            carry >>= 32;
+        }
+        if (carry != 0) {
+            mag.push_back(carry);
+        }
+    }
+
+    // Divides mag by divisor in place and returns the remainder.
+    static uint32_t DivModSmall(Magnitude& mag, uint32_t divisor) {
+        uint64_t rem = 0;
+        for (int i = mag.size() - 1; i >= 0; i--) {
+            uint64_t cur = (rem << 32) | mag[i];
+            mag[i] = cur / divisor;
+            rem = cur % divisor;
+        }
+        Trim(mag);
+        return rem;
+    }
+
+    // Long division (Knuth's algorithm D, as in Hacker's Delight).
+    // Returns the quotient and the remainder.
+    static std::pair<Magnitude, Magnitude> DivMod(const Magnitude& u, const Magnitude& v) {
+        assert(!v.empty());
+        if (Compare(u, v) < 0) {
+            return {Magnitude(), u};
+        }
+        if (v.size() == 1) {
+            Magnitude q = u;
+            uint32_t r = DivModSmall(q, v[0]);
+            return {q, ToMagnitude(r)};
+        }
+
+        const uint64_t b = uint64_t(1) << 32;
+        int m = u.size(), n = v.size();
+        // Normalize, so that the top bit of the divisor is set.
+        int s = std::countl_zero(v[n - 1]);
+        Magnitude vn(n), un(m + 1);
+        for (int i = n - 1; i > 0; i--) {
+            vn[i] = (v[i] << s) | (uint32_t)((uint64_t)v[i - 1] >> (32 - s));
+        }
+        vn[0] = v[0] << s;
+        un[m] = (uint32_t)((uint64_t)u[m - 1] >> (32 - s));
+        for (int i = m - 1; i > 0; i--) {
+            un[i] = (u[i] << s) | (uint32_t)((uint64_t)u[i - 1] >> (32 - s));
+        }
+        un[0] = u[0] << s;
+
+        Magnitude q(m - n + 1);
+        for (int j = m - n; j >= 0; j--) {
+            // Estimate the quotient digit, then correct it by at most 2.
+            uint64_t top = ((uint64_t)un[j + n] << 32) | un[j + n - 1];
+            uint64_t qhat = top / vn[n - 1];
+            uint64_t rhat = top - qhat * vn[n - 1];
+            while (qhat >= b || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+                qhat--;
+                rhat += vn[n - 1];
+                if (rhat >= b) {
+                    break;
+                }
+            }
+
+            // Multiply and subtract.
+            uint64_t borrow = 0;
+            for (int i = 0; i < n; i++) {
+                uint64_t p = qhat * vn[i] + borrow;
+                borrow = (p >> 32) + ((uint32_t)p > un[i + j] ? 1 : 0);
+                un[i + j] -= (uint32_t)p;
+            }
+            bool negative = borrow > un[j + n];
+            un[j + n] -= (uint32_t)borrow;
+
+            // The estimate was one too big: add back.
+            if (negative) {
+                qhat--;
+                uint64_t carry = 0;
+                for (int i = 0; i < n; i++) {
+                    carry += (uint64_t)un[i + j] + vn[i];
+                    un[i + j] = (uint32_t)carry;
+                    carry >>= 32;
+                }
+                un[j + n] += (uint32_t)carry;
+            }
+            q[j] = qhat;
+        }
+
+        Magnitude r(n);
+        for (int i = 0; i < n; i++) {
+            r[i] = (un[i] >> s) | (uint32_t)((uint64_t)un[i + 1] << (32 - s));
+        }
+        Trim(q);
+        Trim(r);
+        return {q, r};
+    }
+
+    bool small_ = true;
+    __int128 value_;
+    bool negative_ = false;
+    Magnitude mag_;
+};
+
+template <>
+struct std::hash<BigInt> {
+    size_t operator()(const BigInt& x) const {
+        if (x.small_) {
+            return SeqHash((long long)(x.value_ >> 64), (long long)x.value_);
+        }
+        size_t h = x.negative_;
+        for (uint32_t limb : x.mag_) {
+            h = CombineHash(h, limb);
+        }
+        return h;
+    }
+};
+
+using BigRat = Rational<BigInt>;
+
+#endif
\ No newline at end of file
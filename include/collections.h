@@ -1,16 +1,26 @@
 #ifndef __AOC_COLLECTIONS_H__
 #define __AOC_COLLECTIONS_H__
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
 #include <iterator>
 #include <optional>
 #include <ranges>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 // Transposes a matrix. Could be a std::vector<std::vector<T>>
 // or std::vector<std::string>.
+//
+// The output is allocated up front and filled in square tiles, so that the
+// input rows being read and the output rows being written both stay in cache
+// even when the matrix is large.
 template <typename C>
 std::vector<C> Transpose(const std::vector<C>& v) {
     int height = v.size();
@@ -21,19 +31,203 @@ std::vector<C> Transpose(const std::vector<C>& v) {
         assert(v[i].size() == width);
     }
 
-    std::vector<C> result;
-    result.reserve(width);
-    for (int j = 0; j < width; j++) {
-        C result_row;
-        result_row.reserve(height);
-        for (int i = 0; i < height; i++) {
-            result_row.push_back(v[i][j]);
+    const int kTile = 64;
+    std::vector<C> result(width, C(height, typename C::value_type()));
+    for (int i0 = 0; i0 < height; i0 += kTile) {
+        int i1 = std::min(height, i0 + kTile);
+        for (int j0 = 0; j0 < width; j0 += kTile) {
+            int j1 = std::min(width, j0 + kTile);
+            for (int j = j0; j < j1; j++) {
+                C& result_row = result[j];
+                for (int i = i0; i < i1; i++) {
+                    result_row[i] = v[i][j];
+                }
+            }
         }
-        result.push_back(std::move(result_row));
     }
     return result;
 }
 
+// Transposes a 64x64 bit matrix in place: bit j of rows[i] goes to bit i of
+// rows[j], where bit 0 is the least significant one.
+void TransposeBits64(std::array<uint64_t, 64>& rows) {
+    uint64_t mask = 0x00000000FFFFFFFFull;
+    for (int k = 32; k != 0; k >>= 1, mask ^= (mask << k)) {
+        for (int i = 0; i < 64; i = ((i | k) + 1) & ~k) {
+            uint64_t t = ((rows[i] >> k) ^ rows[i | k]) & mask;
+            rows[i] ^= t << k;
+            rows[i | k] ^= t;
+        }
+    }
+}
+
+// Transposes a packed bit matrix. Row i of the input holds its bit j in
+// bit (j % 64) of word (j / 64); width is the number of bits per row. The
+// output uses the same layout, with m.size() bits per row. Bits beyond the
+// width are ignored, and padding bits in the output are zero.
+//
+// Works on 64x64 blocks, so it is ~64 times faster than transposing bools.
+std::vector<std::vector<uint64_t>> TransposeBits(
+    const std::vector<std::vector<uint64_t>>& m, int width) {
+    int height = m.size();
+    assert(width >= 0);
+    int in_words = (width + 63) / 64;
+    int out_words = (height + 63) / 64;
+    for (const auto& row : m) {
+        assert(row.size() == in_words);
+    }
+
+    std::vector<std::vector<uint64_t>> result(width, std::vector<uint64_t>(out_words, 0));
+    std::array<uint64_t, 64> block;
+    for (int bi = 0; bi < out_words; bi++) {
+        for (int bj = 0; bj < in_words; bj++) {
+            for (int r = 0; r < 64; r++) {
+                int i = bi * 64 + r;
+                block[r] = (i < height) ? m[i][bj] : 0;
+            }
+            TransposeBits64(block);
+            for (int c = 0; c < 64 && bj * 64 + c < width; c++) {
+                result[bj * 64 + c][bi] = block[c];
+            }
+        }
+    }
+    return result;
+}
+
+// Read-only transposed view of a matrix, e.g. std::vector<std::string>.
+// Nothing is copied: view[j][i] is v[i][j]. Useful when only a few columns
+// are looked at, or each of them only once.
+//
+// The view works with Sizes() and Find(), and its columns can be iterated.
+template <typename C>
+class TransposedView {
+   public:
+    using value_type = C::value_type;
+
+    // A single column of the matrix, i.e. a row of the view.
+    class Column {
+       public:
+        class Iterator {
+           public:
+            using difference_type = std::ptrdiff_t;
+            using value_type = TransposedView::value_type;
+
+            Iterator() {}
+
+            Iterator(const std::vector<C>* v, int i, int j) : v_(v), i_(i), j_(j) {}
+
+            const value_type& operator*() const {
+                return (*v_)[i_][j_];
+            }
+
+            Iterator& operator++() {
+                i_++;
+                return *this;
+            }
+
+            Iterator operator++(int) {
+                Iterator current = *this;
+                ++(*this);
+                return current;
+            }
+
+            bool operator==(const Iterator& other) const {
+                return i_ == other.i_;
+            }
+
+           private:
+            const std::vector<C>* v_ = nullptr;
+            int i_ = 0;
+            int j_ = 0;
+        };
+        using iterator = Iterator;
+
+        Column(const std::vector<C>* v, int j) : v_(v), j_(j) {}
+
+        size_t size() const {
+            return v_->size();
+        }
+
+        const value_type& operator[](int i) const {
+            return (*v_)[i][j_];
+        }
+
+        Iterator begin() const {
+            return Iterator(v_, 0, j_);
+        }
+
+        Iterator end() const {
+            return Iterator(v_, v_->size(), j_);
+        }
+
+       private:
+        const std::vector<C>* v_;
+        int j_;
+    };
+
+    class Iterator {
+       public:
+        using difference_type = std::ptrdiff_t;
+        using value_type = Column;
+
+        Iterator() {}
+
+        Iterator(const std::vector<C>* v, int j) : v_(v), j_(j) {}
+
+        Column operator*() const {
+            return Column(v_, j_);
+        }
+
+        Iterator& operator++() {
+            j_++;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator current = *this;
+            ++(*this);
+            return current;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return j_ == other.j_;
+        }
+
+       private:
+        const std::vector<C>* v_ = nullptr;
+        int j_ = 0;
+    };
+    using iterator = Iterator;
+
+    // The matrix must outlive the view.
+    explicit TransposedView(const std::vector<C>& v) : v_(&v) {
+        width_ = v.empty() ? 0 : v[0].size();
+        for (const C& row : v) {
+            assert(row.size() == width_);
+        }
+    }
+
+    size_t size() const {
+        return width_;
+    }
+
+    Column operator[](int j) const {
+        return Column(v_, j);
+    }
+
+    Iterator begin() const {
+        return Iterator(v_, 0);
+    }
+
+    Iterator end() const {
+        return Iterator(v_, width_);
+    }
+
+   private:
+    const std::vector<C>* v_;
+    int width_;
+};
+
 // Concatenates a container of containers into a single container of the same
 // type as the inner containers.
 template <typename C>
@@ -77,15 +271,103 @@ struct NTupleHelper<0, T> {
 template <size_t n, typename T>
 using NTuple = NTupleHelper<n, T>::Type;
 
+// True if searching for t in cont can be done with memchr() and friends,
+// e.g. for a row of a grid stored as std::string.
+template <typename Cont, typename T>
+concept CharScan = std::is_same_v<T, char> && std::ranges::contiguous_range<Cont> &&
+                   std::is_same_v<std::ranges::range_value_t<Cont>, char>;
+
 // Finds a specific element in a multi-dimensional container. The first
 // template parameter (n) is mandatory.
 //
 // The result is an std::optional of an n-tuple of ints. It is nullopt if
 // the element isn't found, and an actual tuple of the first occurrence if
 // it is found.
+//
+// Rows of chars (e.g. in a std::vector<std::string>) are scanned with
+// memchr().
 template <size_t n, typename Cont, typename T>
 std::optional<NTuple<n, int>> Find(const Cont& cont, const T& t) {
-    return FindIf<n, Cont>(cont, [&t](const T& u) { return u == t; });
+    if constexpr (n == 1 && CharScan<Cont, T>) {
+        const char* data = std::ranges::data(cont);
+        const void* p = std::memchr(data, t, std::ranges::size(cont));
+        if (p == nullptr) {
+            return std::nullopt;
+        }
+        return std::make_tuple((int)((const char*)p - data));
+    } else if constexpr (n == 0) {
+        if (cont == t) {
+            return std::tuple<>();
+        }
+        return std::nullopt;
+    } else {
+        for (int i = 0; i < std::ranges::size(cont); i++) {
+            std::optional<NTuple<n - 1, int>> res = Find<n - 1>(cont[i], t);
+            if (res.has_value()) {
+                return std::tuple_cat(std::make_tuple(i), *std::move(res));
+            }
+        }
+        return std::nullopt;
+    }
+}
+
+// Counts occurrences of an element in a multi-dimensional container. The
+// first template parameter (n) is mandatory.
+//
+// Rows of chars are counted with a branchless loop that vectorizes.
+template <size_t n, typename Cont, typename T>
+long long Count(const Cont& cont, const T& t) {
+    if constexpr (n == 1 && CharScan<Cont, T>) {
+        const char* data = std::ranges::data(cont);
+        size_t size = std::ranges::size(cont);
+        // Unsigned on purpose: signed additions are checked under -ftrapv,
+        // which would keep the loop from being vectorized.
+        size_t result = 0;
+        for (size_t k = 0; k < size; k++) {
+            result += (data[k] == t);
+        }
+        return result;
+    } else if constexpr (n == 0) {
+        return (cont == t) ? 1 : 0;
+    } else {
+        long long result = 0;
+        for (const auto& x : cont) {
+            result += Count<n - 1>(x, t);
+        }
+        return result;
+    }
+}
+
+template <size_t n, typename Cont, typename T, typename Prefix, typename Out>
+void FindAllImpl(const Cont& cont, const T& t, const Prefix& prefix, Out& out) {
+    if constexpr (n == 1 && CharScan<Cont, T>) {
+        const char* data = std::ranges::data(cont);
+        const char* end = data + std::ranges::size(cont);
+        for (const char* p = data;; p++) {
+            p = (const char*)std::memchr(p, t, end - p);
+            if (p == nullptr) {
+                break;
+            }
+            out.push_back(std::tuple_cat(prefix, std::make_tuple((int)(p - data))));
+        }
+    } else if constexpr (n == 0) {
+        if (cont == t) {
+            out.push_back(prefix);
+        }
+    } else {
+        for (int i = 0; i < std::ranges::size(cont); i++) {
+            FindAllImpl<n - 1>(cont[i], t, std::tuple_cat(prefix, std::make_tuple(i)), out);
+        }
+    }
+}
+
+// Finds all occurrences of an element in a multi-dimensional container, in
+// lexicographic order. The first template parameter (n) is mandatory.
+template <size_t n, typename Cont, typename T>
+std::vector<NTuple<n, int>> FindAll(const Cont& cont, const T& t) {
+    std::vector<NTuple<n, int>> result;
+    FindAllImpl<n>(cont, t, std::tuple<>(), result);
+    return result;
 }
 
 // Like Find(), but matches a predicate.
@@ -165,6 +447,204 @@ NTuple<n, int> Sizes(const Cont& cont) {
     }
 }
 
+// A set of values of an ordered type T, usually an integer, stored as a
+// sorted vector of disjoint half-open intervals [begin, end). Overlapping and
+// adjacent intervals are always merged, so the representation is unique.
+//
+// Lookups take O(log n) in the number of intervals. Insert() and Erase() find
+// their place in O(log n) too, then shift the tail of the vector. Set algebra
+// takes time linear in the number of intervals, whatever their lengths.
+template <typename T>
+class IntervalSet {
+   public:
+    using Interval = std::pair<T, T>;
+
+    IntervalSet() = default;
+
+    // Builds the set from intervals in any order, possibly overlapping, in
+    // O(n log n). Empty intervals are ignored.
+    explicit IntervalSet(std::vector<Interval> intervals) {
+        std::erase_if(intervals, [](const Interval& x) { return !(x.first < x.second); });
+        std::sort(intervals.begin(), intervals.end());
+        *this = FromSorted(intervals);
+    }
+
+    IntervalSet(std::initializer_list<Interval> intervals)
+        : IntervalSet(std::vector<Interval>(intervals)) {}
+
+    IntervalSet(const IntervalSet&) = default;
+    IntervalSet& operator=(const IntervalSet&) = default;
+    IntervalSet(IntervalSet&&) = default;
+    IntervalSet& operator=(IntervalSet&&) = default;
+
+    bool operator==(const IntervalSet&) const = default;
+
+    const std::vector<Interval>& Intervals() const {
+        return intervals_;
+    }
+
+    auto begin() const {
+        return intervals_.begin();
+    }
+
+    auto end() const {
+        return intervals_.end();
+    }
+
+    int NumIntervals() const {
+        return intervals_.size();
+    }
+
+    bool empty() const {
+        return intervals_.empty();
+    }
+
+    // Adds [begin, end) to the set.
+    void Insert(T begin, T end) {
+        if (!(begin < end)) {
+            return;
+        }
+        // Intervals from first to last touch or overlap [begin, end).
+        auto first = std::lower_bound(intervals_.begin(), intervals_.end(), begin,
+                                      [](const Interval& x, const T& v) { return x.second < v; });
+        auto last = std::upper_bound(first, intervals_.end(), end,
+                                     [](const T& v, const Interval& x) { return v < x.first; });
+        if (first == last) {
+            intervals_.insert(first, Interval(begin, end));
+            return;
+        }
+        first->first = std::min(first->first, begin);
+        first->second = std::max((last - 1)->second, end);
+        intervals_.erase(first + 1, last);
+    }
+
+    // Removes [begin, end) from the set.
+    void Erase(T begin, T end) {
+        if (!(begin < end)) {
+            return;
+        }
+        // Intervals from first to last overlap [begin, end).
+        auto first = std::upper_bound(intervals_.begin(), intervals_.end(), begin,
+                                      [](const T& v, const Interval& x) { return v < x.second; });
+        auto last = std::lower_bound(first, intervals_.end(), end,
+                                     [](const Interval& x, const T& v) { return x.first < v; });
+        if (first == last) {
+            return;
+        }
+        std::vector<Interval> pieces;
+        if (first->first < begin) {
+            pieces.emplace_back(first->first, begin);
+        }
+        if (end < (last - 1)->second) {
+            pieces.emplace_back(end, (last - 1)->second);
+        }
+        auto it = intervals_.erase(first, last);
+        intervals_.insert(it, pieces.begin(), pieces.end());
+    }
+
+    bool Contains(const T& x) const {
+        auto it = std::upper_bound(intervals_.begin(), intervals_.end(), x,
+                                   [](const T& v, const Interval& y) { return v < y.first; });
+        return it != intervals_.begin() && x < (it - 1)->second;
+    }
+
+    // Total number of values in the set, for integer T.
+    T TotalLength() const {
+        T result = T();
+        for (const auto& [begin, end] : intervals_) {
+            result += end - begin;
+        }
+        return result;
+    }
+
+    // The holes between consecutive intervals.
+    std::vector<Interval> Gaps() const {
+        std::vector<Interval> result;
+        for (int k = 1; k < NumIntervals(); k++) {
+            result.emplace_back(intervals_[k - 1].second, intervals_[k].first);
+        }
+        return result;
+    }
+
+    // The values in [lo, hi) that are not in the set.
+    IntervalSet Complement(T lo, T hi) const {
+        IntervalSet result;
+        T pos = lo;
+        for (const auto& [begin, end] : intervals_) {
+            if (!(begin < hi)) {
+                break;
+            }
+            if (pos < begin) {
+                result.intervals_.emplace_back(pos, begin);
+            }
+            pos = std::max(pos, end);
+        }
+        if (pos < hi) {
+            result.intervals_.emplace_back(pos, hi);
+        }
+        return result;
+    }
+
+    friend IntervalSet operator|(const IntervalSet& a, const IntervalSet& b) {
+        std::vector<Interval> merged;
+        merged.reserve(a.intervals_.size() + b.intervals_.size());
+        std::merge(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(merged));
+        return FromSorted(merged);
+    }
+
+    friend IntervalSet operator&(const IntervalSet& a, const IntervalSet& b) {
+        IntervalSet result;
+        auto x = a.begin(), y = b.begin();
+        while (x != a.end() && y != b.end()) {
+            T begin = std::max(x->first, y->first), end = std::min(x->second, y->second);
+            if (begin < end) {
+                result.intervals_.emplace_back(begin, end);
+            }
+            if (x->second < y->second) {
+                ++x;
+            } else {
+                ++y;
+            }
+        }
+        return result;
+    }
+
+    friend IntervalSet operator-(const IntervalSet& a, const IntervalSet& b) {
+        if (a.empty()) {
+            return a;
+        }
+        return a & b.Complement(a.intervals_.front().first, a.intervals_.back().second);
+    }
+
+    IntervalSet& operator|=(const IntervalSet& other) {
+        return *this = *this | other;
+    }
+
+    IntervalSet& operator&=(const IntervalSet& other) {
+        return *this = *this & other;
+    }
+
+    IntervalSet& operator-=(const IntervalSet& other) {
+        return *this = *this - other;
+    }
+
+   private:
+    // Merges nonempty intervals sorted by their beginnings.
+    static IntervalSet FromSorted(const std::vector<Interval>& sorted) {
+        IntervalSet result;
+        for (const Interval& x : sorted) {
+            if (!result.intervals_.empty() && !(result.intervals_.back().second < x.first)) {
+                result.intervals_.back().second = std::max(result.intervals_.back().second, x.second);
+            } else {
+                result.intervals_.push_back(x);
+            }
+        }
+        return result;
+    }
+
+    std::vector<Interval> intervals_;
+};
+
 size_t CombineHash(size_t h, size_t val) {
     return h ^ ((h * 999983) + 997391 + val);
 }
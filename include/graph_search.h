@@ -2,7 +2,12 @@
 #define __AOC_GRAPH_SEARCH_H__
 
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
 #include <optional>
 #include <queue>
 #include <ranges>
@@ -16,13 +21,129 @@ enum class DFSEdge {
     kCross,
 };
 
-template <typename Node, typename Hasher = std::hash<Node>>
+enum class BFSEdge {
+    kTree = 0,
+    kTight = 1,
+    kLoose = 2,
+};
+
+// Stats policy of the search engines that counts nothing. Its hooks are empty,
+// so a search with it compiles to the same code as without any hooks.
+struct NoSearchStats {
+    void OnVisit() {}
+    void OnLook(DFSEdge) {}
+    void OnLook(BFSEdge) {}
+    void OnPush() {}
+    void OnPop(bool) {}
+    template <typename Map>
+    void OnInsert(const Map&, int = 0) {}
+    void Finish(const char*) {}
+};
+
+// Stats policy that counts the work done by a search. It tells whether a slow
+// solution needs a better queue, a better hash or a better algorithm.
+//
+// The frontier is the DFS stack, the BFS queue or the Dijkstra heap. When the
+// search finishes, the counters are passed to `reporter`, which prints them
+// to std::cerr by default. The visit function can also look at them while
+// the search runs, through search.GetStats().
+//
+// Example:
+//
+// BFSFrom<Coord, std::hash<Coord>, SearchStats>(start, visit);
+struct SearchStats {
+    const char* engine = "";
+    long long visits = 0;
+    std::array<long long, 4> dfs_looks = {};  // Indexed by DFSEdge.
+    std::array<long long, 3> bfs_looks = {};  // Indexed by BFSEdge.
+    long long pushes = 0;
+    long long pops = 0;
+    // Pops of nodes that had already been visited with a smaller distance.
+    long long stale_pops = 0;
+    long long max_frontier = 0;
+    long long rehashes = 0;
+
+    static std::function<void(const SearchStats&)> reporter;
+
+    void OnVisit() {
+        visits++;
+    }
+
+    void OnLook(DFSEdge edge) {
+        dfs_looks[(int)edge]++;
+    }
+
+    void OnLook(BFSEdge edge) {
+        bfs_looks[(int)edge]++;
+    }
+
+    void OnPush() {
+        pushes++;
+        max_frontier = std::max(max_frontier, pushes - pops);
+    }
+
+    void OnPop(bool stale) {
+        pops++;
+        stale_pops += stale;
+    }
+
+    // Called after inserting into a map, to notice when it rehashes. Engines
+    // with more than one map pass a different slot for each.
+    template <typename Map>
+    void OnInsert(const Map& map, int slot = 0) {
+        size_t& buckets = buckets_[slot];
+        if (map.bucket_count() != buckets) {
+            rehashes += (buckets != 0);
+            buckets = map.bucket_count();
+        }
+    }
+
+    void Finish(const char* the_engine) {
+        engine = the_engine;
+        if (reporter) {
+            reporter(*this);
+        }
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const SearchStats& s) {
+        out << s.engine << ": " << s.visits << " visits, ";
+        if (s.dfs_looks != decltype(s.dfs_looks){}) {
+            out << "looks tree/back/forward/cross " << s.dfs_looks[0] << "/" << s.dfs_looks[1]
+                << "/" << s.dfs_looks[2] << "/" << s.dfs_looks[3] << ", ";
+        }
+        if (s.bfs_looks != decltype(s.bfs_looks){}) {
+            out << "looks tree/tight/loose " << s.bfs_looks[0] << "/" << s.bfs_looks[1] << "/"
+                << s.bfs_looks[2] << ", ";
+        }
+        return out << s.pushes << " pushes, " << s.stale_pops << " stale pops, max frontier "
+                   << s.max_frontier << ", " << s.rehashes << " rehashes";
+    }
+
+   private:
+    // Last seen bucket counts, by slot.
+    std::array<size_t, 2> buckets_ = {};
+};
+
+inline std::function<void(const SearchStats&)> SearchStats::reporter =
+    [](const SearchStats& stats) { std::cerr << stats << std::endl; };
+
+// Map from nodes used by the search engines for their bookkeeping and
+// results. Alloc is rebound to the value type of the map, so with a
+// std::pmr::polymorphic_allocator the maps can live in an arena (see arena.h)
+// and cost nothing to tear down. The default gives plain std::unordered_map.
+template <typename Node, typename T, typename Hasher, typename Alloc>
+using SearchMap = std::unordered_map<
+    Node, T, Hasher, std::equal_to<Node>,
+    typename std::allocator_traits<Alloc>::template rebind_alloc<std::pair<const Node, T>>>;
+
+template <typename Node, typename Hasher = std::hash<Node>, typename Alloc = std::allocator<Node>>
 struct DFSResult {
-    std::unordered_map<Node, int, Hasher> enter_times;
-    std::unordered_map<Node, int, Hasher> exit_times;
+    SearchMap<Node, int, Hasher, Alloc> enter_times;
+    SearchMap<Node, int, Hasher, Alloc> exit_times;
 };
 
-template <typename Node, typename Hasher, typename StartFunc, typename VisitFunc>
+template <typename Node, typename Hasher, typename Stats, typename Alloc, typename StartFunc,
+          typename VisitFunc>
 class DFSState {
    public:
     // Tell the search to look at `node`. This means that logically there is
@@ -30,13 +151,45 @@ class DFSState {
     //
     // Returns the edge class of this logical edge w.r.t. the DFS forest.
     DFSEdge Look(const Node& node) {
+        DFSEdge edge = Classify(node);
+        stats_.OnLook(edge);
+        return edge;
+    }
+
+    const std::vector<Node>& Path() const {
+        return path_;
+    }
+
+    int Depth() const {
+        return path_.size() - 1;
+    }
+
+    std::optional<Node> Parent() {
+        return (path_.size() < 2) ? std::nullopt
+                                  : std::optional<Node>(path_[path_.size() - 2]);
+    }
+
+    const Stats& GetStats() const {
+        return stats_;
+    }
+
+   private:
+    DFSState(VisitFunc& visit, const Alloc& alloc)
+        : visit_(visit), enter_times_(alloc), exit_times_(alloc) {}
+
+    DFSEdge Classify(const Node& node) {
         auto [enter_it, inserted] = enter_times_.insert(std::make_pair(node, time_));
         if (inserted) {
+            stats_.OnInsert(enter_times_);
+            stats_.OnPush();
+            stats_.OnVisit();
             time_++;
             path_.push_back(node);
             visit_(*this, node);
             path_.pop_back();
+            stats_.OnPop(false);
             exit_times_.insert(std::make_pair(node, time_));
+            stats_.OnInsert(exit_times_, 1);
             time_++;
             return DFSEdge::kTree;
         }
@@ -52,92 +205,66 @@ class DFSState {
         return DFSEdge::kForward;
     }
 
-    const std::vector<Node>& Path() const {
-        return path_;
-    }
-
-    int Depth() const {
-        return path_.size() - 1;
-    }
-
-    std::optional<Node> Parent() {
-        return (path_.size() < 2) ? std::nullopt
-                                  : std::optional<Node>(path_[path_.size() - 2]);
-    }
-
-   private:
-    DFSState(VisitFunc& visit) : visit_(visit) {}
-
-    friend DFSResult<Node, Hasher> DFS<Node, Hasher, StartFunc, VisitFunc>(
-        StartFunc&&, VisitFunc&&);
+    friend DFSResult<Node, Hasher, Alloc> DFS<Node, Hasher, Stats, Alloc, StartFunc, VisitFunc>(
+        StartFunc&&, VisitFunc&&, const Alloc&);
 
     VisitFunc& visit_;
     int time_ = 0;
-    std::unordered_map<Node, int, Hasher> enter_times_;
-    std::unordered_map<Node, int, Hasher> exit_times_;
+    SearchMap<Node, int, Hasher, Alloc> enter_times_;
+    SearchMap<Node, int, Hasher, Alloc> exit_times_;
     std::vector<Node> path_;
+    [[no_unique_address]] Stats stats_;
 };
 
-template <typename Node, typename Hasher = std::hash<Node>,
-          typename StartFunc, typename VisitFunc>
-DFSResult<Node, Hasher> DFS(StartFunc&& start, VisitFunc&& visit) {
-    DFSState<Node, Hasher, StartFunc, VisitFunc> state(visit);
+template <typename Node, typename Hasher = std::hash<Node>, typename Stats = NoSearchStats,
+          typename Alloc = std::allocator<Node>, typename StartFunc, typename VisitFunc>
+DFSResult<Node, Hasher, Alloc> DFS(StartFunc&& start, VisitFunc&& visit,
+                                   const Alloc& alloc = Alloc()) {
+    DFSState<Node, Hasher, Stats, Alloc, StartFunc, VisitFunc> state(visit, alloc);
     start(state);
+    state.stats_.Finish("DFS");
     return {
         .enter_times = std::move(state.enter_times_),
         .exit_times = std::move(state.exit_times_),
     };
 }
 
-template <typename Node, typename Hasher = std::hash<Node>,
-          typename VisitFunc>
-DFSResult<Node, Hasher> DFSFrom(const Node& start, VisitFunc&& visit) {
-    return DFS<Node, Hasher>(
+template <typename Node, typename Hasher = std::hash<Node>, typename Stats = NoSearchStats,
+          typename Alloc = std::allocator<Node>, typename VisitFunc>
+DFSResult<Node, Hasher, Alloc> DFSFrom(const Node& start, VisitFunc&& visit,
+                                       const Alloc& alloc = Alloc()) {
+    return DFS<Node, Hasher, Stats>(
         [&start](auto& search) { search.Look(start); },
-        std::forward<VisitFunc>(visit));
+        std::forward<VisitFunc>(visit), alloc);
 }
 
-template <typename Node, typename Hasher = std::hash<Node>,
-          std::ranges::input_range Range, typename VisitFunc>
-DFSResult<Node, Hasher> DFSFrom(const Range& range, VisitFunc&& visit) {
-    return DFS<Node, Hasher>(
+template <typename Node, typename Hasher = std::hash<Node>, typename Stats = NoSearchStats,
+          typename Alloc = std::allocator<Node>, std::ranges::input_range Range,
+          typename VisitFunc>
+DFSResult<Node, Hasher, Alloc> DFSFrom(const Range& range, VisitFunc&& visit,
+                                       const Alloc& alloc = Alloc()) {
+    return DFS<Node, Hasher, Stats>(
         [&range](auto& search) {
             for (const Node& node : range) {
                 search.Look(node);
             }
         },
-        std::forward<VisitFunc>(visit));
+        std::forward<VisitFunc>(visit), alloc);
 }
 
-enum class BFSEdge {
-    kTree = 0,
-    kTight = 1,
-    kLoose = 2,
-};
-
 // The result of BFS() is the map containing the depths of all visited nodes.
 // Nodes discovered by StartFunc have depth 0, other nodes have depth > 0.
-template <typename Node, typename Hasher = std::hash<Node>>
-using BFSResult = std::unordered_map<Node, int, Hasher>;
+template <typename Node, typename Hasher = std::hash<Node>, typename Alloc = std::allocator<Node>>
+using BFSResult = SearchMap<Node, int, Hasher, Alloc>;
 
-template <typename Node, typename Hasher, typename StartFunc, typename VisitFunc>
+template <typename Node, typename Hasher, typename Stats, typename Alloc, typename StartFunc,
+          typename VisitFunc>
 class BFSState {
    public:
     BFSEdge Look(const Node& node) {
-        int depth = Depth();
-        auto [iter, inserted] = depths_.insert(std::make_pair(node, depth + 1));
-        if (inserted) {
-            queue_.push(node);
-            if (current_.has_value()) {
-                parents_[node] = *current_;
-            }
-            return BFSEdge::kTree;
-        }
-        if (iter->second == depth + 1) {
-            return BFSEdge::kTight;
-        }
-        assert(iter->second <= depth);
-        return BFSEdge::kLoose;
+        BFSEdge edge = Classify(node);
+        stats_.OnLook(edge);
+        return edge;
     }
 
     int Depth() const {
@@ -161,59 +288,93 @@ class BFSState {
         return aborted_;
     }
 
+    const Stats& GetStats() const {
+        return stats_;
+    }
+
    private:
-    BFSState() = default;
+    explicit BFSState(const Alloc& alloc) : queue_(alloc), depths_(alloc), parents_(alloc) {}
+
+    BFSEdge Classify(const Node& node) {
+        int depth = Depth();
+        auto [iter, inserted] = depths_.insert(std::make_pair(node, depth + 1));
+        if (inserted) {
+            stats_.OnInsert(depths_);
+            queue_.push(node);
+            stats_.OnPush();
+            if (current_.has_value()) {
+                parents_[node] = *current_;
+            }
+            return BFSEdge::kTree;
+        }
+        if (iter->second == depth + 1) {
+            return BFSEdge::kTight;
+        }
+        assert(iter->second <= depth);
+        return BFSEdge::kLoose;
+    }
 
     void Run(StartFunc&& start, VisitFunc&& visit) {
         start(*this);
         while (!queue_.empty() && !aborted_) {
             current_ = queue_.front();
             queue_.pop();
+            stats_.OnPop(false);
+            stats_.OnVisit();
             visit(*this, *current_);
         }
+        stats_.Finish("BFS");
     }
 
-    friend BFSResult<Node, Hasher> BFS<Node, Hasher, StartFunc, VisitFunc>(
-        StartFunc&&, VisitFunc&&);
+    friend BFSResult<Node, Hasher, Alloc> BFS<Node, Hasher, Stats, Alloc, StartFunc, VisitFunc>(
+        StartFunc&&, VisitFunc&&, const Alloc&);
+
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
 
-    std::queue<Node> queue_;
-    std::unordered_map<Node, int, Hasher> depths_;
-    std::unordered_map<Node, Node> parents_;
+    std::queue<Node, std::deque<Node, NodeAlloc>> queue_;
+    SearchMap<Node, int, Hasher, Alloc> depths_;
+    SearchMap<Node, Node, Hasher, Alloc> parents_;
     std::optional<Node> current_;
     bool aborted_ = false;
+    [[no_unique_address]] Stats stats_;
 };
 
-template <typename Node, typename Hasher = std::hash<Node>,
-          typename StartFunc, typename VisitFunc>
-BFSResult<Node, Hasher> BFS(StartFunc&& start, VisitFunc&& visit) {
-    BFSState<Node, Hasher, StartFunc, VisitFunc> state;
+template <typename Node, typename Hasher = std::hash<Node>, typename Stats = NoSearchStats,
+          typename Alloc = std::allocator<Node>, typename StartFunc, typename VisitFunc>
+BFSResult<Node, Hasher, Alloc> BFS(StartFunc&& start, VisitFunc&& visit,
+                                   const Alloc& alloc = Alloc()) {
+    BFSState<Node, Hasher, Stats, Alloc, StartFunc, VisitFunc> state(alloc);
     state.Run(std::forward<StartFunc>(start), std::forward<VisitFunc>(visit));
     return std::move(state.depths_);
 }
 
-template <typename Node, typename Hasher = std::hash<Node>,
-          typename VisitFunc>
-BFSResult<Node, Hasher> BFSFrom(const Node& start, VisitFunc&& visit) {
-    return BFS<Node, Hasher>(
+template <typename Node, typename Hasher = std::hash<Node>, typename Stats = NoSearchStats,
+          typename Alloc = std::allocator<Node>, typename VisitFunc>
+BFSResult<Node, Hasher, Alloc> BFSFrom(const Node& start, VisitFunc&& visit,
+                                       const Alloc& alloc = Alloc()) {
+    return BFS<Node, Hasher, Stats>(
         [&start](auto& search) { search.Look(start); },
-        std::forward<VisitFunc>(visit));
+        std::forward<VisitFunc>(visit), alloc);
 }
 
-template <typename Node, typename Hasher = std::hash<Node>,
-          std::ranges::input_range Range, typename VisitFunc>
-BFSResult<Node, Hasher> BFSFrom(const Range& range, VisitFunc&& visit) {
-    return BFS<Node, Hasher>(
+template <typename Node, typename Hasher = std::hash<Node>, typename Stats = NoSearchStats,
+          typename Alloc = std::allocator<Node>, std::ranges::input_range Range,
+          typename VisitFunc>
+BFSResult<Node, Hasher, Alloc> BFSFrom(const Range& range, VisitFunc&& visit,
+                                       const Alloc& alloc = Alloc()) {
+    return BFS<Node, Hasher, Stats>(
         [&range](auto& search) {
             for (const Node& node : range) {
                 search.Look(node);
             }
         },
-        std::forward<VisitFunc>(visit));
+        std::forward<VisitFunc>(visit), alloc);
 }
 
 // The result of Diskstra() is the set of vertices that have been reached.
-template <typename Node, typename Dist, typename Hasher = std::hash<Node>>
-using DijkstraResult = std::unordered_map<Node, Dist, Hasher>;
+template <typename Node, typename Dist, typename Hasher = std::hash<Node>,
+          typename Alloc = std::allocator<Node>>
+using DijkstraResult = SearchMap<Node, Dist, Hasher, Alloc>;
 
 template <typename Node, typename Dist>
 struct DistUpdate {
@@ -293,11 +454,12 @@ class ShortQueue {
     std::unordered_map<int, std::vector<DistUpdate<Node, int>>> buckets_;
 };
 
-template <typename Node, typename Dist, typename Hasher, typename PQueue,
-          typename StartFunc, typename VisitFunc>
+template <typename Node, typename Dist, typename Hasher, typename PQueue, typename Stats,
+          typename Alloc, typename StartFunc, typename VisitFunc>
 class DiskstraState {
    public:
     void Look(const Node& node, Dist dist) {
+        stats_.OnPush();
         queue_.Push({
             .node = node,
             .dist = dist,
@@ -314,8 +476,12 @@ class DiskstraState {
         return current_.has_value() ? current_->parent : std::nullopt;
     }
 
+    const Stats& GetStats() const {
+        return stats_;
+    }
+
    private:
-    DiskstraState() = default;
+    explicit DiskstraState(const Alloc& alloc) : distances_(alloc) {}
 
     void Run(StartFunc&& start, VisitFunc&& visit) {
         start(*this);
@@ -323,37 +489,45 @@ class DiskstraState {
             current_ = queue_.Pop();
             auto [_, inserted] = distances_.insert(
                 std::make_pair(current_->node, current_->dist));
+            stats_.OnPop(!inserted);
             if (inserted) {
+                stats_.OnInsert(distances_);
+                stats_.OnVisit();
                 visit(*this, current_->node, current_->dist);
             }
         }
+        stats_.Finish("Dijkstra");
     }
 
-    friend DijkstraResult<Node, Dist, Hasher>
-    Dijkstra<Node, Dist, Hasher, PQueue, StartFunc, VisitFunc>(
-        StartFunc&&, VisitFunc&&);
+    friend DijkstraResult<Node, Dist, Hasher, Alloc>
+    Dijkstra<Node, Dist, Hasher, PQueue, Stats, Alloc, StartFunc, VisitFunc>(
+        StartFunc&&, VisitFunc&&, const Alloc&);
 
     PQueue queue_;
-    std::unordered_map<Node, Dist, Hasher> distances_;
+    SearchMap<Node, Dist, Hasher, Alloc> distances_;
     std::optional<DistUpdate<Node, Dist>> current_ = std::nullopt;
+    [[no_unique_address]] Stats stats_;
 };
 
 template <typename Node, typename Dist,
           typename Hasher = std::hash<Node>, typename PQueue = HeapQueue<Node, Dist>,
+          typename Stats = NoSearchStats, typename Alloc = std::allocator<Node>,
           typename StartFunc, typename VisitFunc>
-DijkstraResult<Node, Dist, Hasher> Dijkstra(StartFunc&& start, VisitFunc&& visit) {
-    DiskstraState<Node, Dist, Hasher, PQueue, StartFunc, VisitFunc> state;
+DijkstraResult<Node, Dist, Hasher, Alloc> Dijkstra(StartFunc&& start, VisitFunc&& visit,
+                                                   const Alloc& alloc = Alloc()) {
+    DiskstraState<Node, Dist, Hasher, PQueue, Stats, Alloc, StartFunc, VisitFunc> state(alloc);
     state.Run(std::forward<StartFunc>(start), std::forward<VisitFunc>(visit));
     return std::move(state.distances_);
 }
 
 template <typename Node, typename Dist, typename Hasher = std::hash<Node>,
-          typename PQueue = HeapQueue<Node, Dist>, typename VisitFunc>
-DijkstraResult<Node, Dist, Hasher>
-DijkstraFrom(const Node& start, Dist dist, VisitFunc&& visit) {
-    return Dijkstra<Node, Dist, Hasher, PQueue>(
+          typename PQueue = HeapQueue<Node, Dist>, typename Stats = NoSearchStats,
+          typename Alloc = std::allocator<Node>, typename VisitFunc>
+DijkstraResult<Node, Dist, Hasher, Alloc>
+DijkstraFrom(const Node& start, Dist dist, VisitFunc&& visit, const Alloc& alloc = Alloc()) {
+    return Dijkstra<Node, Dist, Hasher, PQueue, Stats>(
         [&start, &dist](auto& search) { search.Look(start, dist); },
-        std::forward<VisitFunc>(visit));
+        std::forward<VisitFunc>(visit), alloc);
 }
 
 #endif
\ No newline at end of file
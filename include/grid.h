@@ -1,11 +1,19 @@
 #ifndef __AOC_GRID_H__
 #define __AOC_GRID_H__
 
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include "collections.h"
+#include "parse.h"
 
 // Coordinates on a grid. i grows "down" or "towards the south".
 // j grows "right" or "towards the east".
@@ -576,4 +584,266 @@ struct std::hash<PosDir> {
     }
 };
 
+// A dense rectangular grid stored contiguously in row-major order. Cells can
+// be accessed either as grid[c] for a Coord c or as grid[i][j].
+//
+// Use char or uint8_t instead of bool for flags: std::vector<bool> is not
+// contiguous.
+template <typename T>
+class Grid {
+   public:
+    static_assert(!std::is_same_v<T, bool>);
+
+    Grid() : Grid(0, 0) {}
+
+    Grid(int size_i, int size_j, const T& val = T())
+        : size_i_(size_i), size_j_(size_j), data_((size_t)size_i * size_j, val) {
+        assert(size_i >= 0);
+        assert(size_j >= 0);
+    }
+
+    Grid(const Grid&) = default;
+    Grid& operator=(const Grid&) = default;
+    Grid(Grid&&) = default;
+    Grid& operator=(Grid&&) = default;
+
+    int SizeI() const {
+        return size_i_;
+    }
+
+    int SizeJ() const {
+        return size_j_;
+    }
+
+    Box Bounds() const {
+        return Box(size_i_, size_j_);
+    }
+
+    bool contains(const Coord& c) const {
+        return c.i >= 0 && c.i < size_i_ && c.j >= 0 && c.j < size_j_;
+    }
+
+    // Offset of the cell in Data().
+    size_t Index(const Coord& c) const {
+        assert(contains(c));
+        return (size_t)c.i * size_j_ + c.j;
+    }
+
+    T& operator[](const Coord& c) {
+        return data_[Index(c)];
+    }
+
+    const T& operator[](const Coord& c) const {
+        return data_[Index(c)];
+    }
+
+    // Pointer to the beginning of row i, so that grid[i][j] works.
+    T* operator[](int i) {
+        assert(i >= 0 && i < size_i_);
+        return data_.data() + (size_t)i * size_j_;
+    }
+
+    const T* operator[](int i) const {
+        assert(i >= 0 && i < size_i_);
+        return data_.data() + (size_t)i * size_j_;
+    }
+
+    std::vector<T>& Data() {
+        return data_;
+    }
+
+    const std::vector<T>& Data() const {
+        return data_;
+    }
+
+    bool operator==(const Grid&) const = default;
+
+   private:
+    int size_i_;
+    int size_j_;
+    std::vector<T> data_;
+};
+
+// A rectangular grid of chars that addresses the text of a puzzle input in
+// place. Rows are separated by '\n', so cell (i, j) lives at offset
+// i * Stride() + j of Text(). Building one doesn't copy the text.
+class CharGrid {
+   public:
+    CharGrid() = default;
+
+    // Takes ownership of the text and validates its shape in one pass. Dies
+    // if the rows don't all have the same length. Trailing newlines are
+    // ignored.
+    explicit CharGrid(std::string text) : text_(std::move(text)) {
+        size_t length = text_.size();
+        while (length > 0 && text_[length - 1] == '\n') {
+            length--;
+        }
+        text_.resize(length);
+        if (length == 0) {
+            return;
+        }
+
+        const char* data = text_.data();
+        const char* end = data + length;
+        const char* newline = (const char*)std::memchr(data, '\n', length);
+        size_j_ = (newline == nullptr) ? length : newline - data;
+        assert(size_j_ > 0);
+        for (const char* row = data;; row += size_j_ + 1) {
+            size_i_++;
+            if (row + size_j_ == end) {
+                break;
+            }
+            // Each row must be followed by a newline, and must not contain
+            // one of its own.
+            assert(row + size_j_ < end);
+            assert(row[size_j_] == '\n');
+            assert(std::memchr(row, '\n', size_j_) == nullptr);
+        }
+    }
+
+    CharGrid(const CharGrid&) = default;
+    CharGrid& operator=(const CharGrid&) = default;
+    CharGrid(CharGrid&&) = default;
+    CharGrid& operator=(CharGrid&&) = default;
+
+    int SizeI() const {
+        return size_i_;
+    }
+
+    int SizeJ() const {
+        return size_j_;
+    }
+
+    // Distance in Text() between the beginnings of two consecutive rows.
+    int Stride() const {
+        return size_j_ + 1;
+    }
+
+    Box Bounds() const {
+        return Box(size_i_, size_j_);
+    }
+
+    bool contains(const Coord& c) const {
+        return c.i >= 0 && c.i < size_i_ && c.j >= 0 && c.j < size_j_;
+    }
+
+    // Offset of the cell in Text().
+    size_t Index(const Coord& c) const {
+        assert(contains(c));
+        return (size_t)c.i * Stride() + c.j;
+    }
+
+    char& operator[](const Coord& c) {
+        return text_[Index(c)];
+    }
+
+    char operator[](const Coord& c) const {
+        return text_[Index(c)];
+    }
+
+    // Row i without the trailing newline, so that grid[i][j] works.
+    std::string_view operator[](int i) const {
+        assert(i >= 0 && i < size_i_);
+        return std::string_view(text_).substr((size_t)i * Stride(), size_j_);
+    }
+
+    const std::string& Text() const {
+        return text_;
+    }
+
+    // Copies the rows out, in the format most solutions work with.
+    std::vector<std::string> Rows() const {
+        std::vector<std::string> result;
+        result.reserve(size_i_);
+        for (int i = 0; i < size_i_; i++) {
+            result.emplace_back((*this)[i]);
+        }
+        return result;
+    }
+
+    // Builds a typed contiguous grid by applying f to every cell.
+    template <typename F>
+    auto Convert(F f) const -> Grid<decltype(f(char()))> {
+        Grid<decltype(f(char()))> result(size_i_, size_j_);
+        auto* out = result.Data().data();
+        for (int i = 0; i < size_i_; i++) {
+            const char* row = text_.data() + (size_t)i * Stride();
+            for (int j = 0; j < size_j_; j++) {
+                *out++ = f(row[j]);
+            }
+        }
+        return result;
+    }
+
+    // Converts a grid of decimal digits to their values.
+    Grid<uint8_t> Digits() const {
+        return Convert([](char c) {
+            assert(c >= '0' && c <= '9');
+            return (uint8_t)(c - '0');
+        });
+    }
+
+   private:
+    std::string text_;
+    int size_i_ = 0;
+    int size_j_ = 0;
+};
+
+// Reads a rectangular grid from a file with a single read. See CharGrid.
+CharGrid ReadGrid(const std::string& filename) {
+    return CharGrid(GetContents(filename));
+}
+
+// Find(), Count() and FindAll() for a CharGrid scan its whole text at once
+// instead of going row by row.
+template <size_t n>
+std::optional<NTuple<n, int>> Find(const CharGrid& grid, char c)
+    requires(n == 2)
+{
+    assert(c != '\n');
+    const char* data = grid.Text().data();
+    const void* p = std::memchr(data, c, grid.Text().size());
+    if (p == nullptr) {
+        return std::nullopt;
+    }
+    int offset = (const char*)p - data;
+    return std::make_tuple(offset / grid.Stride(), offset % grid.Stride());
+}
+
+template <size_t n>
+long long Count(const CharGrid& grid, char c)
+    requires(n == 2)
+{
+    assert(c != '\n');
+    return Count<1>(grid.Text(), c);
+}
+
+template <size_t n>
+std::vector<NTuple<n, int>> FindAll(const CharGrid& grid, char c)
+    requires(n == 2)
+{
+    assert(c != '\n');
+    std::vector<NTuple<n, int>> result;
+    const char* data = grid.Text().data();
+    const char* end = data + grid.Text().size();
+    for (const char* p = data;; p++) {
+        p = (const char*)std::memchr(p, c, end - p);
+        if (p == nullptr) {
+            break;
+        }
+        int offset = p - data;
+        result.push_back(std::make_tuple(offset / grid.Stride(), offset % grid.Stride()));
+    }
+    return result;
+}
+
+// All the cells of a 2D grid (e.g. std::vector<std::string> or CharGrid)
+// that contain the given char, in row-major order.
+template <typename Cont>
+std::vector<Coord> FindCoords(const Cont& grid, char c) {
+    std::vector<NTuple<2, int>> found = FindAll<2>(grid, c);
+    return std::vector<Coord>(found.begin(), found.end());
+}
+
 #endif
\ No newline at end of file
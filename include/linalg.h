@@ -0,0 +1,410 @@
+#ifndef __AOC_LINALG_H__
+#define __AOC_LINALG_H__
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <initializer_list>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Dense matrix over a field: Rational, ModInt or a floating point type.
+// Entries are stored row-major in one contiguous block.
+template <typename T>
+class Matrix {
+   public:
+    Matrix() : Matrix(0, 0) {}
+
+    Matrix(int rows, int cols, const T& val = T(0))
+        : rows_(rows), cols_(cols), data_((size_t)rows * cols, val) {
+        assert(rows >= 0);
+        assert(cols >= 0);
+    }
+
+    // Matrix<LLRat> m = {{1, 2}, {3, 4}};
+    Matrix(std::initializer_list<std::initializer_list<T>> rows)
+        : Matrix(rows.size(), rows.size() == 0 ? 0 : rows.begin()->size()) {
+        T* out = data_.data();
+        for (const auto& row : rows) {
+            assert((int)row.size() == cols_);
+            out = std::copy(row.begin(), row.end(), out);
+        }
+    }
+
+    Matrix(const Matrix&) = default;
+    Matrix& operator=(const Matrix&) = default;
+    Matrix(Matrix&&) = default;
+    Matrix& operator=(Matrix&&) = default;
+
+    static Matrix Identity(int n) {
+        Matrix result(n, n);
+        for (int i = 0; i < n; i++) {
+            result[i][i] = T(1);
+        }
+        return result;
+    }
+
+    int Rows() const {
+        return rows_;
+    }
+
+    int Cols() const {
+        return cols_;
+    }
+
+    // Pointer to the beginning of a row, so that m[i][j] works.
+    T* operator[](int i) {
+        assert(i >= 0 && i < rows_);
+        return data_.data() + (size_t)i * cols_;
+    }
+
+    const T* operator[](int i) const {
+        assert(i >= 0 && i < rows_);
+        return data_.data() + (size_t)i * cols_;
+    }
+
+    bool operator==(const Matrix& other) const = default;
+
+    friend Matrix operator*(const Matrix& a, const Matrix& b) {
+        assert(a.cols_ == b.rows_);
+        Matrix result(a.rows_, b.cols_);
+        for (int i = 0; i < a.rows_; i++) {
+            for (int k = 0; k < a.cols_; k++) {
+                const T& x = a[i][k];
+                for (int j = 0; j < b.cols_; j++) {
+                    result[i][j] += x * b[k][j];
+                }
+            }
+        }
+        return result;
+    }
+
+    friend std::vector<T> operator*(const Matrix& a, const std::vector<T>& x) {
+        assert(a.cols_ == (int)x.size());
+        std::vector<T> result(a.rows_, T(0));
+        for (int i = 0; i < a.rows_; i++) {
+            for (int j = 0; j < a.cols_; j++) {
+                result[i] += a[i][j] * x[j];
+            }
+        }
+        return result;
+    }
+
+    void SwapRows(int i1, int i2) {
+        if (i1 != i2) {
+            std::swap_ranges((*this)[i1], (*this)[i1] + cols_, (*this)[i2]);
+        }
+    }
+
+   private:
+    int rows_;
+    int cols_;
+    std::vector<T> data_;
+};
+
+// Entries of floating point matrices smaller than this in absolute value are
+// treated as zeros by the row reduction.
+const double kLinalgEpsilon = 1e-9;
+
+template <typename T>
+bool IsZeroEntry(const T& x) {
+    if constexpr (std::floating_point<T>) {
+        return std::abs(x) <= kLinalgEpsilon;
+    } else {
+        return x == T(0);
+    }
+}
+
+// Row index in [from, rows) to pivot on in the given column, or -1 if all
+// entries there are zero. Floating point matrices use the entry with the
+// largest absolute value, for stability. Exact types take the first nonzero.
+template <typename T>
+int FindPivot(const Matrix<T>& m, int col, int from) {
+    int best = -1;
+    for (int i = from; i < m.Rows(); i++) {
+        if (IsZeroEntry(m[i][col])) {
+            continue;
+        }
+        if constexpr (!std::floating_point<T>) {
+            return i;
+        } else if (best == -1 || std::abs(m[i][col]) > std::abs(m[best][col])) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Gauss-Jordan elimination: brings m to the reduced row echelon form in
+// place. Only the first num_cols columns are used for pivots, which is handy
+// for augmented matrices. Returns the pivot columns, one per nonzero row, so
+// its size is the rank.
+template <typename T>
+std::vector<int> RowReduce(Matrix<T>& m, int num_cols) {
+    assert(num_cols >= 0 && num_cols <= m.Cols());
+    std::vector<int> pivots;
+    for (int col = 0; col < num_cols && (int)pivots.size() < m.Rows(); col++) {
+        int row = pivots.size();
+        int pivot = FindPivot(m, col, row);
+        if (pivot == -1) {
+            continue;
+        }
+        m.SwapRows(row, pivot);
+
+        T inverse = T(1) / m[row][col];
+        for (int j = col; j < m.Cols(); j++) {
+            m[row][j] *= inverse;
+        }
+        for (int i = 0; i < m.Rows(); i++) {
+            if (i == row || IsZeroEntry(m[i][col])) {
+                continue;
+            }
+            T factor = m[i][col];
+            for (int j = col; j < m.Cols(); j++) {
+                m[i][j] -= factor * m[row][j];
+            }
+        }
+        pivots.push_back(col);
+    }
+    return pivots;
+}
+
+template <typename T>
+std::vector<int> RowReduce(Matrix<T>& m) {
+    return RowReduce(m, m.Cols());
+}
+
+template <typename T>
+int Rank(Matrix<T> m) {
+    return RowReduce(m).size();
+}
+
+// Determinant of a square matrix, by Gaussian elimination.
+template <typename T>
+T Determinant(Matrix<T> m) {
+    assert(m.Rows() == m.Cols());
+    T result = T(1);
+    for (int col = 0; col < m.Cols(); col++) {
+        int pivot = FindPivot(m, col, col);
+        if (pivot == -1) {
+            return T(0);
+        }
+        if (pivot != col) {
+            m.SwapRows(col, pivot);
+            result = -result;
+        }
+        result *= m[col][col];
+        T inverse = T(1) / m[col][col];
+        for (int i = col + 1; i < m.Rows(); i++) {
+            if (IsZeroEntry(m[i][col])) {
+                continue;
+            }
+            T factor = m[i][col] * inverse;
+            for (int j = col; j < m.Cols(); j++) {
+                m[i][j] -= factor * m[col][j];
+            }
+        }
+    }
+    return result;
+}
+
+// Finds some x such that a * x == b: the one where all free variables are
+// zero. Returns nullopt if there is no solution.
+template <typename T>
+std::optional<std::vector<T>> SolveLinear(const Matrix<T>& a, const std::vector<T>& b) {
+    assert(a.Rows() == (int)b.size());
+    int n = a.Cols();
+    Matrix<T> aug(a.Rows(), n + 1);
+    for (int i = 0; i < a.Rows(); i++) {
+        std::copy(a[i], a[i] + n, aug[i]);
+        aug[i][n] = b[i];
+    }
+
+    std::vector<int> pivots = RowReduce(aug, n);
+    for (int i = pivots.size(); i < aug.Rows(); i++) {
+        if (!IsZeroEntry(aug[i][n])) {
+            return std::nullopt;
+        }
+    }
+    std::vector<T> x(n, T(0));
+    for (int r = 0; r < (int)pivots.size(); r++) {
+        x[pivots[r]] = aug[r][n];
+    }
+    return x;
+}
+
+// Basis of the space of solutions of a * x == 0: one vector per free
+// variable, with that variable equal to 1 and the other free ones 0.
+template <typename T>
+std::vector<std::vector<T>> NullSpace(Matrix<T> a) {
+    std::vector<int> pivots = RowReduce(a);
+    std::vector<bool> is_pivot(a.Cols(), false);
+    for (int col : pivots) {
+        is_pivot[col] = true;
+    }
+
+    std::vector<std::vector<T>> basis;
+    for (int free = 0; free < a.Cols(); free++) {
+        if (is_pivot[free]) {
+            continue;
+        }
+        std::vector<T> v(a.Cols(), T(0));
+        v[free] = T(1);
+        for (int r = 0; r < (int)pivots.size(); r++) {
+            v[pivots[r]] = -a[r][free];
+        }
+        basis.push_back(std::move(v));
+    }
+    return basis;
+}
+
+// Determinant of a small n x n matrix by cofactor expansion. It is
+// straight-line code without divisions, which the compiler can unroll. The
+// cost grows as n!, so this is meant for n up to 4 or so.
+template <int n, typename T>
+T SmallDeterminant(const std::array<T, n * n>& m) {
+    if constexpr (n == 1) {
+        return m[0];
+    } else if constexpr (n == 2) {
+        return m[0] * m[3] - m[1] * m[2];
+    } else {
+        T result = T(0);
+        for (int k = 0; k < n; k++) {
+            std::array<T, (n - 1) * (n - 1)> minor;
+            for (int i = 1; i < n; i++) {
+                for (int j = 0, out = 0; j < n; j++) {
+                    if (j != k) {
+                        minor[(i - 1) * (n - 1) + out++] = m[i * n + j];
+                    }
+                }
+            }
+            T term = m[k] * SmallDeterminant<n - 1, T>(minor);
+            result = (k % 2 == 0) ? result + term : result - term;
+        }
+        return result;
+    }
+}
+
+// Determinants of many small n x n matrices at once, the same way as
+// SmallDeterminant(): entry e of matrix s is entries[e][s], and the
+// determinant goes to out[s]. Every step of the expansion is a loop over all
+// matrices, which the compiler can vectorize.
+template <int n, typename T>
+void SmallDeterminants(const std::array<const T*, n * n>& entries, int size, T* out) {
+    if constexpr (n == 1) {
+        std::copy(entries[0], entries[0] + size, out);
+    } else if constexpr (n == 2) {
+        const T *a = entries[0], *b = entries[1], *c = entries[2], *d = entries[3];
+        for (int s = 0; s < size; s++) {
+            out[s] = a[s] * d[s] - b[s] * c[s];
+        }
+    } else {
+        std::fill(out, out + size, T(0));
+        std::vector<T> minor_dets(size);
+        for (int k = 0; k < n; k++) {
+            // The minor only picks entries, so no copying is needed.
+            std::array<const T*, (n - 1) * (n - 1)> minor;
+            for (int i = 1; i < n; i++) {
+                for (int j = 0, col = 0; j < n; j++) {
+                    if (j != k) {
+                        minor[(i - 1) * (n - 1) + col++] = entries[i * n + j];
+                    }
+                }
+            }
+            SmallDeterminants<n - 1, T>(minor, size, minor_dets.data());
+            const T* top = entries[k];
+            if (k % 2 == 0) {
+                for (int s = 0; s < size; s++) {
+                    out[s] = out[s] + top[s] * minor_dets[s];
+                }
+            } else {
+                for (int s = 0; s < size; s++) {
+                    out[s] = out[s] - top[s] * minor_dets[s];
+                }
+            }
+        }
+    }
+}
+
+// Many independent n x n systems a * x == b, solved together by Cramer's
+// rule: x[k] == Numerator(s, k) / Det(s). Works over integers too, with no
+// divisions at all, so the caller can check whether solutions are integral.
+//
+// Coefficients are stored as a structure of arrays: every entry position has
+// its own vector indexed by the system. Solve() works through all systems at
+// once with SmallDeterminants(), in loops over consecutive memory with no
+// pivoting branches. Note that -ftrapv keeps the compiler from vectorizing
+// integer loops (see AOC_TRAPV in CMakeLists.txt).
+//
+// Example:
+//
+// LinearSystemBatch<2, long long> batch(machines.size());
+// for (int s = 0; s < batch.Size(); s++) {
+//     batch.A(s, 0, 0) = ...;
+//     batch.B(s, 0) = ...;
+// }
+// batch.Solve();
+template <int n, typename T>
+class LinearSystemBatch {
+   public:
+    explicit LinearSystemBatch(int size) : size_(size) {
+        for (std::vector<T>& entries : a_) {
+            entries.assign(size, T(0));
+        }
+        for (int i = 0; i < n; i++) {
+            b_[i].assign(size, T(0));
+            numerators_[i].assign(size, T(0));
+        }
+        det_.assign(size, T(0));
+    }
+
+    int Size() const {
+        return size_;
+    }
+
+    T& A(int s, int i, int j) {
+        return a_[i * n + j][s];
+    }
+
+    T& B(int s, int i) {
+        return b_[i][s];
+    }
+
+    void Solve() {
+        std::array<const T*, n * n> entries;
+        for (int e = 0; e < n * n; e++) {
+            entries[e] = a_[e].data();
+        }
+        SmallDeterminants<n, T>(entries, size_, det_.data());
+        for (int k = 0; k < n; k++) {
+            // Column k replaced with b.
+            std::array<const T*, n * n> replaced = entries;
+            for (int i = 0; i < n; i++) {
+                replaced[i * n + k] = b_[i].data();
+            }
+            SmallDeterminants<n, T>(replaced, size_, numerators_[k].data());
+        }
+    }
+
+    // Determinant of the matrix of system s. The system has a unique solution
+    // iff it's nonzero. Available after Solve().
+    const T& Det(int s) const {
+        return det_[s];
+    }
+
+    // Det(s) times the k-th unknown of system s. Available after Solve().
+    const T& Numerator(int s, int k) const {
+        return numerators_[k][s];
+    }
+
+   private:
+    int size_;
+    std::array<std::vector<T>, n * n> a_;
+    std::array<std::vector<T>, n> b_;
+    std::array<std::vector<T>, n> numerators_;
+    std::vector<T> det_;
+};
+
+#endif
\ No newline at end of file
@@ -1,10 +1,20 @@
 #ifndef __AOC_NUMBERS_H__
 #define __AOC_NUMBERS_H__
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cmath>
 #include <compare>
 #include <concepts>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <optional>
 #include <ostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -81,25 +91,151 @@ T Inverse(T x, T m) {
 
 // Divisions with different sorts of rounding.
 
+// Calls f(p) for every prime p that is less than bound, in ascending order.
+//
+// This is a segmented sieve of Eratosthenes: only odd numbers are stored, one
+// bit each, and they are sieved in L1-sized segments starting from p^2 for
+// every prime p. Memory use is O(sqrt(bound)), so it can stream primes well
+// beyond what fits in RAM.
+// Time: O(bound * log log bound).
+template <typename T, typename F>
+void ForEachPrime(T bound, F&& f) {
+    if (bound <= 2) {
+        return;
+    }
+    f(T(2));
+
+    // Odd primes up to sqrt(bound) do all the crossing off.
+    long long root = std::sqrt((long double)bound);
+    while (root * root >= bound) {
+        root--;
+    }
+    while ((root + 1) * (root + 1) < bound) {
+        root++;
+    }
+    std::vector<long long> base;
+    {
+        std::vector<bool> has_divisor(root + 1, false);
+        for (long long i = 3; i <= root; i += 2) {
+            if (has_divisor[i]) {
+                continue;
+            }
+            base.push_back(i);
+            for (long long j = i * i; j <= root; j += 2 * i) {
+                has_divisor[j] = true;
+            }
+        }
+    }
+    // The next odd multiple of each base prime that hasn't been crossed off.
+    std::vector<long long> next;
+    for (long long p : base) {
+        next.push_back(p * p);
+    }
+
+    // Bit k of a segment stands for the number low + 2 * k.
+    const long long kSegmentBits = 32 * 1024 * 8;
+    std::vector<uint64_t> bits(kSegmentBits / 64);
+    for (long long low = 1; low < bound; low += 2 * kSegmentBits) {
+        long long high = std::min<long long>(bound, low + 2 * kSegmentBits);
+        std::fill(bits.begin(), bits.end(), ~uint64_t(0));
+        if (low == 1) {
+            bits[0] &= ~uint64_t(1);
+        }
+
+        // Offsets within the segment are unsigned, so that -ftrapv doesn't
+        // add overflow checks to the innermost loop.
+        uint64_t size = (high - low + 1) / 2;
+        for (size_t i = 0; i < base.size(); i++) {
+            uint64_t k = (next[i] - low) / 2;
+            uint64_t p = base[i];
+            for (; k < size; k += p) {
+                bits[k / 64] &= ~(uint64_t(1) << (k % 64));
+            }
+            next[i] = low + 2 * k;
+        }
+
+        for (uint64_t w = 0; w * 64 < size; w++) {
+            for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                uint64_t k = w * 64 + std::countr_zero(word);
+                if (k >= size) {
+                    break;
+                }
+                f(T(low + 2 * k));
+            }
+        }
+    }
+}
+
 // Generates all primes that are less than bound, in ascending order.
 // Time: O(bound * log log bound).
 template <typename T>
 std::vector<T> GetPrimes(T bound) {
-    std::vector<bool> has_divisor(bound, false);
     std::vector<T> result;
+    ForEachPrime(bound, [&result](T p) { result.push_back(p); });
+    return result;
+}
 
-    for (T i = 2; i < bound; i++) {
-        if (has_divisor[i]) {
-            continue;
+// Smallest prime factors of all numbers below some n, computed with a linear
+// sieve. Afterwards any number below n can be factorized in O(log n).
+// Memory: 4 bytes per number.
+class SmallestFactorTable {
+   public:
+    explicit SmallestFactorTable(int n) : factors_(std::max(n, 2), 0) {
+        for (int i = 2; i < n; i++) {
+            if (factors_[i] == 0) {
+                factors_[i] = i;
+                primes_.push_back(i);
+            }
+            for (int p : primes_) {
+                if (p > factors_[i] || (long long)p * i >= n) {
+                    break;
+                }
+                factors_[p * i] = p;
+            }
         }
-        result.push_back(i);
-        for (T j = 2 * i; j < bound; j += i) {
-            has_divisor[j] = true;
+    }
+
+    // Numbers in [0, Size()) can be queried.
+    int Size() const {
+        return factors_.size();
+    }
+
+    // The smallest prime factor of x >= 2.
+    int SmallestFactor(int x) const {
+        assert(x >= 2 && x < Size());
+        return factors_[x];
+    }
+
+    bool IsPrime(int x) const {
+        assert(x >= 0 && x < Size());
+        return x >= 2 && factors_[x] == x;
+    }
+
+    // All primes below Size(), in ascending order.
+    const std::vector<int>& Primes() const {
+        return primes_;
+    }
+
+    // Prime factorization of x >= 1 as (prime, exponent) pairs, with primes
+    // in ascending order.
+    std::vector<std::pair<int, int>> Factorize(int x) const {
+        assert(x >= 1 && x < Size());
+        std::vector<std::pair<int, int>> result;
+        while (x > 1) {
+            int p = factors_[x];
+            int e = 0;
+            for (; x % p == 0; x /= p) {
+                e++;
+            }
+            result.emplace_back(p, e);
         }
+        return result;
     }
 
-    return result;
-}
+   private:
+    std::vector<int> factors_;
+    std::vector<int> primes_;
+};
 
 // Divide and round towards -infinity.
 template <typename T>
@@ -137,15 +273,157 @@ T RoundDiv(T a, T b) {
     return (a >= 0) ? ((2 * a + b) / (2 * b)) : ((2 * a - b) / (2 * b));
 }
 
-// Rational numbers. T is the type of numerator and denominator.
+// Prints a 128-bit integer, which std::ostream doesn't support by itself.
+std::ostream& operator<<(std::ostream& out, __int128 x) {
+    // Digits are produced from the lowest one. They are negated separately
+    // because -x overflows for the smallest value.
+    std::string digits;
+    bool negative = x < 0;
+    do {
+        int digit = x % 10;
+        digits.push_back('0' + (digit < 0 ? -digit : digit));
+        x /= 10;
+    } while (x != 0);
+    if (negative) {
+        digits.push_back('-');
+    }
+    return out << std::string(digits.rbegin(), digits.rend());
+}
+
+// True if x can be converted to T without changing its value.
+template <typename T, typename U>
+bool FitsInto(U x) {
+    return static_cast<U>(static_cast<T>(x)) == x;
+}
+
+template <typename T>
+struct WideHelper {
+    using Type = T;
+};
+
+template <>
+struct WideHelper<int> {
+    using Type = long long;
+};
+
+template <>
+struct WideHelper<long> {
+    using Type = __int128;
+};
+
+template <>
+struct WideHelper<long long> {
+    using Type = __int128;
+};
+
+// An integer type at least twice as wide as T, if there is one, or T itself.
+template <typename T>
+using Wide = WideHelper<T>::Type;
+
+// Chinese remainder theorem for moduli that need not be coprime: finds x
+// such that x == a1 (mod m1) and x == a2 (mod m2). Returns (x, lcm(m1, m2))
+// with 0 <= x < lcm, or nullopt if there is no solution.
+//
+// A single Euclid() call gives both the gcd and the inverse. Intermediate
+// products are computed in Wide<T>, so anything works as long as the lcm fits
+// into T.
+template <typename T>
+std::optional<std::pair<T, T>> SolveCRT(T a1, T m1, T a2, T m2) {
+    using W = Wide<T>;
+    assert(m1 > 0 && m2 > 0);
+    a1 = SafeMod(a1, m1);
+    a2 = SafeMod(a2, m2);
+
+    // m1 * p + m2 * q == g, so p is the inverse of m1 / g modulo m2 / g.
+    auto [p, q] = Euclid(m1, m2);
+    T g = static_cast<T>((W)m1 * p + (W)m2 * q);
+    if ((a2 - a1) % g != 0) {
+        return std::nullopt;
+    }
+    T m2g = m2 / g;
+    W lcm = (W)m1 * m2g;
+    assert(FitsInto<T>(lcm));
+
+    T k = static_cast<T>(SafeMod<W>((W)((a2 - a1) / g % m2g) * p, m2g));
+    return std::make_pair(static_cast<T>(a1 + (W)m1 * k), static_cast<T>(lcm));
+}
+
+// Solves a system of congruences {x == a (mod m)}, given as (a, m) pairs.
+// Returns (x, lcm of all m) with 0 <= x < lcm, or nullopt if there is no
+// solution.
+template <typename T>
+std::optional<std::pair<T, T>> SolveCRT(const std::vector<std::pair<T, T>>& congruences) {
+    std::optional<std::pair<T, T>> result = std::make_pair(T(0), T(1));
+    for (const auto& [a, m] : congruences) {
+        result = SolveCRT(result->first, result->second, a, m);
+        if (!result.has_value()) {
+            break;
+        }
+    }
+    return result;
+}
+
+// Finds the first time at which several periodic processes all hit.
+//
+// Each process is an (offset, period, hits) triple: from time offset on, it
+// hits at times offset + h + k * period for every h in hits and every k >= 0.
+// Hits are taken modulo the period. Returns nullopt if the processes never
+// hit together.
+//
+// All combinations of hits are tried, so the work is proportional to the
+// product of the sizes of the hit sets.
 template <typename T>
+std::optional<T> CombineCycles(const std::vector<std::tuple<T, T, std::vector<T>>>& cycles) {
+    // Residues modulo the lcm of the periods seen so far.
+    std::vector<T> residues = {0};
+    T modulus = 1, start = 0;
+    for (const auto& [offset, period, hits] : cycles) {
+        start = std::max(start, offset);
+        std::vector<T> next;
+        for (T r : residues) {
+            for (T h : hits) {
+                if (auto solution = SolveCRT(r, modulus, offset + h, period)) {
+                    next.push_back(solution->first);
+                }
+            }
+        }
+        std::sort(next.begin(), next.end());
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+        if (next.empty()) {
+            return std::nullopt;
+        }
+        residues = std::move(next);
+        modulus = Lcm(modulus, period);
+    }
+
+    // The smallest time >= start with one of the residues.
+    std::optional<T> result;
+    for (T r : residues) {
+        T t = (r >= start) ? r : r + (start - r + modulus - 1) / modulus * modulus;
+        if (!result.has_value() || t < *result) {
+            result = t;
+        }
+    }
+    return result;
+}
+
+// Rational numbers. T is the type of numerator and denominator.
+//
+// Intermediate products are computed in Wide<T>, and common factors are
+// cancelled before multiplying (as in Knuth's TAOCP 4.5.1), so results that
+// fit into T are computed without overflow.
+//
+// Values are normally kept reduced. With kLazy = true, arithmetic skips the
+// gcd computations, and fractions are only reduced when they would not fit
+// into T otherwise, or when they are looked at (Num(), Denom(), printing).
+template <typename T, bool kLazy = false>
 class Rational {
    public:
     Rational() : n_(0), d_(1) {}
 
     template <class U>
     Rational(U x)
-        requires std::integral<U>
+        requires std::integral<U> || std::same_as<U, T>
         : n_(static_cast<T>(x)), d_(1) {}
 
     Rational(const Rational&) = default;
@@ -153,15 +431,17 @@ class Rational {
     Rational(Rational&&) = default;
     Rational& operator=(Rational&&) = default;
 
-    template <typename U>
-    explicit Rational(const Rational<U>& other) : n_(static_cast<T>(other.Num())), d_(static_cast<T>(other.Denom())) {}
+    template <typename U, bool kOtherLazy>
+    explicit Rational(const Rational<U, kOtherLazy>& other) : n_(static_cast<T>(other.Num())), d_(static_cast<T>(other.Denom())) {}
 
+    // Numerator of the reduced fraction.
     T Num() const {
-        return n_;
+        return kLazy ? Normal().n_ : n_;
     }
 
+    // Denominator of the reduced fraction. Always positive.
     T Denom() const {
-        return d_;
+        return kLazy ? Normal().d_ : d_;
     }
 
     Rational Normal() const {
@@ -170,10 +450,11 @@ class Rational {
     }
 
     friend std::ostream& operator<<(std::ostream& out, const Rational& r) {
-        if (r.d_ == 1) {
-            return out << r.n_;
+        Rational normal = kLazy ? r.Normal() : r;
+        if (normal.d_ == 1) {
+            return out << normal.n_;
         }
-        return out << r.n_ << '/' << r.d_;
+        return out << normal.n_ << '/' << normal.d_;
     }
 
     // Equality comparison.
@@ -184,7 +465,15 @@ class Rational {
         // arithmetic overflow, complain now before the error propagates
         // further.
         assert(d_ != 0 && other.d_ != 0);
-        return n_ * other.d_ == d_ * other.n_;
+        if constexpr (!kLazy) {
+            // Both are reduced, with positive denominators.
+            return n_ == other.n_ && d_ == other.d_;
+        } else if constexpr (sizeof(Wide<T>) > sizeof(T)) {
+            return (Wide<T>)n_ * other.d_ == (Wide<T>)d_ * other.n_;
+        } else {
+            Rational a = Normal(), b = other.Normal();
+            return a.n_ == b.n_ && a.d_ == b.d_;
+        }
     }
 
     template <typename U>
@@ -207,12 +496,14 @@ class Rational {
     // Order comparison.
 
     std::strong_ordering operator<=>(const Rational& other) const {
-        Rational x = *this - other;
-
         // This is a "terminating" operation (doesn't return Rational), so we
         // check now if Rational computations produced an invalid value.
-        assert(x.d_ != 0);
-        return (x.d_ > 0) ? (x.n_ <=> 0) : (0 <=> x.n_);
+        assert(d_ > 0 && other.d_ > 0);
+        if constexpr (sizeof(Wide<T>) > sizeof(T)) {
+            return (Wide<T>)n_ * other.d_ <=> (Wide<T>)other.n_ * d_;
+        } else {
+            return (*this - other).n_ <=> 0;
+        }
     }
 
     template <typename U>
@@ -235,7 +526,21 @@ class Rational {
     // Addition.
 
     Rational operator+(const Rational& other) const {
-        return Rational(n_ * other.d_ + other.n_ * d_, d_ * other.d_).Normal();
+        using W = Wide<T>;
+        if constexpr (kLazy) {
+            return FromWide((W)n_ * other.d_ + (W)other.n_ * d_, (W)d_ * other.d_);
+        } else {
+            // With g = gcd(d1, d2), the sum is t / (d1 * d2 / g) where
+            // t = n1 * (d2 / g) + n2 * (d1 / g). Any common factor of t and
+            // the denominator divides g.
+            T g = Gcd(d_, other.d_);
+            W t = (W)n_ * (other.d_ / g) + (W)other.n_ * (d_ / g);
+            if (g == 1) {
+                return FromWide(t, (W)d_ * other.d_);
+            }
+            W g2 = Gcd(t, (W)g);
+            return FromWide(t / g2, (W)(d_ / g) * (other.d_ / g2));
+        }
     }
 
     template <typename U>
@@ -281,7 +586,7 @@ class Rational {
     // Subtraction.
 
     Rational operator-(const Rational& other) const {
-        return Rational(n_ * other.d_ - other.n_ * d_, d_ * other.d_).Normal();
+        return *this + (-other);
     }
 
     template <typename U>
@@ -321,7 +626,14 @@ class Rational {
     // Multiplication.
 
     Rational operator*(const Rational& other) const {
-        return Rational(n_ * other.n_, d_ * other.d_).Normal();
+        using W = Wide<T>;
+        if constexpr (kLazy) {
+            return FromWide((W)n_ * other.n_, (W)d_ * other.d_);
+        } else {
+            // Cancel before multiplying, so that the result is reduced.
+            T g1 = Gcd(n_, other.d_), g2 = Gcd(other.n_, d_);
+            return FromWide((W)(n_ / g1) * (other.n_ / g2), (W)(d_ / g2) * (other.d_ / g1));
+        }
     }
 
     template <typename U>
@@ -362,7 +674,9 @@ class Rational {
 
     Rational operator/(const Rational& other) const {
         assert(other.n_ != 0);
-        return Rational(n_ * other.d_, other.n_ * d_).Normal();
+        Rational inverse = (other.n_ > 0) ? Rational(other.d_, other.n_)
+                                          : Rational(-other.d_, -other.n_);
+        return *this * inverse;
     }
 
     template <typename U>
@@ -502,43 +816,386 @@ class Rational {
     }
 
     Rational Abs() const {
-        return Rational(std::abs(n_), std::abs(d_));
+        return Rational((n_ < 0) ? -n_ : n_, d_);
     }
 
    private:
+    template <typename U, bool kOtherLazy>
+    friend class Rational;
+
     Rational(T num, T denom) : n_(num), d_(denom) {}
 
+    // Makes num / denom out of intermediate results. Reduces the fraction if
+    // it doesn't fit into T otherwise. The denominator must be positive.
+    static Rational FromWide(Wide<T> num, Wide<T> denom) {
+        if (num == 0) {
+            return Rational(0, 1);
+        }
+        if (!FitsInto<T>(num) || !FitsInto<T>(denom)) {
+            Wide<T> g = Gcd(num, denom);
+            num /= g;
+            denom /= g;
+            assert(FitsInto<T>(num) && FitsInto<T>(denom));
+        }
+        return Rational(num, denom);
+    }
+
     T n_;
     T d_;
 };
 
-template <typename T>
-Rational<T> floor(const Rational<T>& r) {
+template <typename T, bool kLazy>
+Rational<T, kLazy> floor(const Rational<T, kLazy>& r) {
     return r.Floor();
 }
 
-template <typename T>
-Rational<T> ceil(const Rational<T>& r) {
+template <typename T, bool kLazy>
+Rational<T, kLazy> ceil(const Rational<T, kLazy>& r) {
     return r.Ceil();
 }
 
-template <typename T>
-Rational<T> trunc(const Rational<T>& r) {
+template <typename T, bool kLazy>
+Rational<T, kLazy> trunc(const Rational<T, kLazy>& r) {
     return r.Trunc();
 }
 
-template <typename T>
-Rational<T> round(const Rational<T>& r) {
+template <typename T, bool kLazy>
+Rational<T, kLazy> round(const Rational<T, kLazy>& r) {
     return r.Round();
 }
 
-template <typename T>
-Rational<T> abs(const Rational<T>& r) {
+template <typename T, bool kLazy>
+Rational<T, kLazy> abs(const Rational<T, kLazy>& r) {
     return r.Abs();
 }
 
 using Rat = Rational<int>;
 using LRat = Rational<long>;
 using LLRat = Rational<long long>;
+using I128Rat = Rational<__int128>;
+
+// Barrett reduction: multiplies modulo m without a hardware division, using
+// a precomputed approximation of 2^64 / m. Works for 1 <= m < 2^31.
+class Barrett {
+   public:
+    explicit Barrett(uint32_t m) : m_(m), im_(~uint64_t(0) / m + 1) {
+        assert(m >= 1 && m < (1u << 31));
+    }
+
+    uint32_t Mod() const {
+        return m_;
+    }
+
+    // a * b mod m, for a, b in [0, m).
+    uint32_t Mul(uint32_t a, uint32_t b) const {
+        uint64_t z = (uint64_t)a * b;
+        uint64_t x = (uint64_t)(((unsigned __int128)z * im_) >> 64);
+        uint64_t y = x * m_;
+        return (uint32_t)(z - y + (z < y ? m_ : 0));
+    }
+
+   private:
+    uint32_t m_;
+    uint64_t im_;
+};
+
+// Modulus known at compile time. The compiler already replaces division by
+// a constant with multiplications.
+template <uint32_t m>
+struct StaticMod {
+    static_assert(m >= 1 && m < (1u << 31));
+
+    static constexpr uint32_t Mod() {
+        return m;
+    }
+
+    static constexpr uint32_t Mul(uint32_t a, uint32_t b) {
+        return (uint64_t)a * b % m;
+    }
+};
+
+// Modulus chosen at runtime, shared by all values with the same id. See
+// DynModInt::SetMod(). Multiplications use Barrett reduction.
+template <int id>
+struct DynamicMod {
+    static void Set(uint32_t m) {
+        barrett = Barrett(m);
+    }
+
+    static uint32_t Mod() {
+        return barrett.Mod();
+    }
+
+    static uint32_t Mul(uint32_t a, uint32_t b) {
+        return barrett.Mul(a, b);
+    }
+
+    static inline Barrett barrett{1};
+};
+
+// An element of Z/mZ. The modulus comes from the policy: see ModInt and
+// DynModInt below.
+template <typename Modulus>
+class ModIntBase {
+   public:
+    constexpr ModIntBase() : v_(0) {}
+
+    template <typename U>
+    constexpr ModIntBase(U x)
+        requires std::integral<U>
+    {
+        if constexpr (std::is_signed_v<U>) {
+            using Wide = std::common_type_t<U, long long>;
+            Wide r = (Wide)x % (Wide)Mod();
+            v_ = (r < 0) ? r + Mod() : r;
+        } else {
+            using Wide = std::common_type_t<U, unsigned long long>;
+            v_ = (Wide)x % (Wide)Mod();
+        }
+    }
+
+    static constexpr uint32_t Mod() {
+        return Modulus::Mod();
+    }
+
+    // Changes the modulus of all values of this type. Only for DynModInt.
+    // Values computed before become meaningless.
+    static void SetMod(uint32_t m) {
+        Modulus::Set(m);
+    }
+
+    // The representative in [0, Mod()).
+    constexpr uint32_t Val() const {
+        return v_;
+    }
+
+    // Binary operators are friends, so that integers on either side get
+    // converted.
+
+    friend constexpr ModIntBase operator+(const ModIntBase& a, const ModIntBase& b) {
+        uint32_t r = a.v_ + b.v_;
+        return Raw(r >= Mod() ? r - Mod() : r);
+    }
+
+    friend constexpr ModIntBase operator-(const ModIntBase& a, const ModIntBase& b) {
+        return Raw(a.v_ >= b.v_ ? a.v_ - b.v_ : a.v_ + Mod() - b.v_);
+    }
+
+    constexpr ModIntBase operator-() const {
+        return Raw(v_ == 0 ? 0 : Mod() - v_);
+    }
+
+    friend constexpr ModIntBase operator*(const ModIntBase& a, const ModIntBase& b) {
+        return Raw(Modulus::Mul(a.v_, b.v_));
+    }
+
+    // Dies if b is not invertible.
+    friend constexpr ModIntBase operator/(const ModIntBase& a, const ModIntBase& b) {
+        return a * b.Inv();
+    }
+
+    constexpr ModIntBase& operator+=(const ModIntBase& other) {
+        return *this = *this + other;
+    }
+
+    constexpr ModIntBase& operator-=(const ModIntBase& other) {
+        return *this = *this - other;
+    }
+
+    constexpr ModIntBase& operator*=(const ModIntBase& other) {
+        return *this = *this * other;
+    }
+
+    constexpr ModIntBase& operator/=(const ModIntBase& other) {
+        return *this = *this / other;
+    }
+
+    friend constexpr bool operator==(const ModIntBase&, const ModIntBase&) = default;
+
+    // Raises to a non-negative power by repeated squaring.
+    constexpr ModIntBase Pow(long long e) const {
+        assert(e >= 0);
+        ModIntBase result = 1, x = *this;
+        for (; e > 0; e >>= 1) {
+            if (e & 1) {
+                result *= x;
+            }
+            x *= x;
+        }
+        return result;
+    }
+
+    // Multiplicative inverse, computed with Inverse(). Dies if the value and
+    // the modulus are not coprime.
+    constexpr ModIntBase Inv() const {
+        return Raw(Inverse<long long>(v_, Mod()));
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const ModIntBase& x) {
+        return out << x.v_;
+    }
+
+   private:
+    static constexpr ModIntBase Raw(uint32_t v) {
+        ModIntBase result;
+        result.v_ = v;
+        return result;
+    }
+
+    uint32_t v_;
+};
+
+template <uint32_t m>
+using ModInt = ModIntBase<StaticMod<m>>;
+
+template <int id = 0>
+using DynModInt = ModIntBase<DynamicMod<id>>;
+
+template <typename Modulus>
+ModIntBase<Modulus> Inverse(const ModIntBase<Modulus>& x) {
+    return x.Inv();
+}
+
+// Replaces every element with its inverse using Montgomery's trick: a single
+// Inverse() call plus 3 multiplications per element. Dies if any element is
+// not invertible.
+template <typename Modulus>
+void BatchInverse(std::vector<ModIntBase<Modulus>>& xs) {
+    if (xs.empty()) {
+        return;
+    }
+    // prefix[i] is the product of xs[0..i).
+    std::vector<ModIntBase<Modulus>> prefix(xs.size());
+    ModIntBase<Modulus> acc = 1;
+    for (size_t i = 0; i < xs.size(); i++) {
+        prefix[i] = acc;
+        acc *= xs[i];
+    }
+    // Now acc is the inverse of the product of xs[0..i].
+    acc = acc.Inv();
+    for (size_t i = xs.size(); i-- > 0;) {
+        ModIntBase<Modulus> inverse = acc * prefix[i];
+        acc *= xs[i];
+        xs[i] = inverse;
+    }
+}
+
+// An integer that dies on overflow instead of wrapping around, also without
+// -ftrapv. Meant for the few values that can really get big, like answers and
+// products, so that the rest of the code may be built without -ftrapv:
+//
+// Checked<long long> answer = 0;
+// for (...) {
+//     answer += Checked<long long>(count) * cost;
+// }
+// std::cout << answer << std::endl;
+//
+// Overflow is detected with __builtin_*_overflow, which costs a single
+// branch on the flags of the operation. Integers on either side of an
+// operator are converted, and the conversion is checked as well.
+template <std::integral T>
+class Checked {
+   public:
+    constexpr Checked() : v_(0) {}
+
+    template <std::integral U>
+    constexpr Checked(U x) {
+        Check(__builtin_add_overflow(x, U(0), &v_));
+    }
+
+    constexpr T Val() const {
+        return v_;
+    }
+
+    constexpr explicit operator T() const {
+        return v_;
+    }
+
+    friend constexpr Checked operator+(const Checked& a, const Checked& b) {
+        T r;
+        Check(__builtin_add_overflow(a.v_, b.v_, &r));
+        return Raw(r);
+    }
+
+    friend constexpr Checked operator-(const Checked& a, const Checked& b) {
+        T r;
+        Check(__builtin_sub_overflow(a.v_, b.v_, &r));
+        return Raw(r);
+    }
+
+    friend constexpr Checked operator*(const Checked& a, const Checked& b) {
+        T r;
+        Check(__builtin_mul_overflow(a.v_, b.v_, &r));
+        return Raw(r);
+    }
+
+    // Dies on division by zero and on lowest() / -1.
+    friend constexpr Checked operator/(const Checked& a, const Checked& b) {
+        Check(!CanDivide(a.v_, b.v_));
+        return Raw(a.v_ / b.v_);
+    }
+
+    friend constexpr Checked operator%(const Checked& a, const Checked& b) {
+        Check(!CanDivide(a.v_, b.v_));
+        return Raw(a.v_ % b.v_);
+    }
+
+    constexpr Checked operator-() const {
+        return Checked(0) - *this;
+    }
+
+    constexpr Checked& operator+=(const Checked& other) {
+        return *this = *this + other;
+    }
+
+    constexpr Checked& operator-=(const Checked& other) {
+        return *this = *this - other;
+    }
+
+    constexpr Checked& operator*=(const Checked& other) {
+        return *this = *this * other;
+    }
+
+    constexpr Checked& operator/=(const Checked& other) {
+        return *this = *this / other;
+    }
+
+    constexpr Checked& operator%=(const Checked& other) {
+        return *this = *this % other;
+    }
+
+    friend constexpr bool operator==(const Checked&, const Checked&) = default;
+    friend constexpr auto operator<=>(const Checked&, const Checked&) = default;
+
+    friend std::ostream& operator<<(std::ostream& out, const Checked& x) {
+        return out << x.v_;
+    }
+
+   private:
+    static constexpr Checked Raw(T v) {
+        Checked result;
+        result.v_ = v;
+        return result;
+    }
+
+    // Dies if an operation overflowed, even with NDEBUG, like -ftrapv.
+    static constexpr void Check(bool overflow) {
+        if (overflow) {
+            assert(!"integer overflow");
+            std::abort();
+        }
+    }
+
+    static constexpr bool CanDivide(T a, T b) {
+        if constexpr (std::is_signed_v<T>) {
+            if (b == -1 && a == std::numeric_limits<T>::lowest()) {
+                return false;
+            }
+        }
+        return b != 0;
+    }
+
+    T v_;
+};
 
 #endif
\ No newline at end of file
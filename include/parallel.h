@@ -0,0 +1,353 @@
+#ifndef __AOC_PARALLEL_H__
+#define __AOC_PARALLEL_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "grid.h"
+
+// A fixed set of worker threads with a work-stealing scheduler. Every worker
+// has its own deque of tasks: it pushes and pops at the back, while idle
+// workers steal from the front of the others' deques. Threads that are not
+// workers of the pool share one more deque.
+//
+// Tasks are submitted through a TaskGroup or ParallelFor(). Tasks may submit
+// and wait for tasks of their own: a thread waiting for a group keeps running
+// other tasks meanwhile, so nesting doesn't deadlock. When there is nothing
+// to run, it sleeps until a task is queued or its group finishes.
+class ThreadPool {
+   public:
+    // The thread that waits for a TaskGroup also runs tasks, so a pool of n
+    // threads starts n - 1 extra ones.
+    explicit ThreadPool(int num_threads) : num_threads_(num_threads) {
+        assert(num_threads > 0);
+        for (int i = 0; i < num_threads; i++) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (int i = 1; i < num_threads; i++) {
+            workers_.emplace_back([this, i]() { WorkerLoop(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    int NumThreads() const {
+        return num_threads_;
+    }
+
+    // The number of threads in the default pool: the value of the AOC_THREADS
+    // environment variable if it is set, or the number of hardware threads.
+    static int DefaultNumThreads() {
+        if (const char* env = std::getenv("AOC_THREADS"); env != nullptr && std::atoi(env) > 0) {
+            return std::atoi(env);
+        }
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // The pool shared by everything in the process, so that independent
+    // parallel loops don't oversubscribe the cores.
+    static ThreadPool& Default() {
+        static ThreadPool pool(DefaultNumThreads());
+        return pool;
+    }
+
+   private:
+    friend class TaskGroup;
+
+    using Task = std::function<void()>;
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // Index of the deque owned by the calling thread.
+    int OwnQueue() const {
+        return (current_pool_ == this) ? current_index_ : 0;
+    }
+
+    void Push(Task task) {
+        Queue& queue = *queues_[OwnQueue()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        bool waiters;
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            queued_++;
+            waiters = waiters_ > 0;
+        }
+        wake_.notify_one();
+        if (waiters) {
+            group_wake_.notify_all();
+        }
+    }
+
+    // Marks a task of a group as finished. Only the pool is touched after
+    // the decrement, since the group may be destroyed right then.
+    void Finish(std::atomic<int>& pending) {
+        bool waiters;
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            pending--;
+            waiters = waiters_ > 0;
+        }
+        if (waiters) {
+            group_wake_.notify_all();
+        }
+    }
+
+    // Sleeps until pending is 0 or there is a task to run.
+    void Sleep(const std::atomic<int>& pending) {
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        waiters_++;
+        group_wake_.wait(lock, [&]() { return pending == 0 || queued_ > 0; });
+        waiters_--;
+    }
+
+    // Runs one task: the newest one from the own deque, or else the oldest
+    // one from somebody else's. Returns false if there was nothing to run.
+    bool RunOne() {
+        int own = OwnQueue();
+        std::optional<Task> task = Take(own, true);
+        for (int k = 1; k < num_threads_ && !task.has_value(); k++) {
+            task = Take((own + k) % num_threads_, false);
+        }
+        if (!task.has_value()) {
+            return false;
+        }
+        (*task)();
+        return true;
+    }
+
+    std::optional<Task> Take(int index, bool back) {
+        Queue& queue = *queues_[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return std::nullopt;
+        }
+        Task task;
+        if (back) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        queued_--;
+        return task;
+    }
+
+    void WorkerLoop(int index) {
+        current_pool_ = this;
+        current_index_ = index;
+        while (true) {
+            if (RunOne()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            wake_.wait(lock, [this]() { return stopping_ || queued_ > 0; });
+            if (stopping_ && queued_ == 0) {
+                return;
+            }
+        }
+    }
+
+    static inline thread_local const ThreadPool* current_pool_ = nullptr;
+    static inline thread_local int current_index_ = 0;
+
+    int num_threads_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<int> queued_ = 0;
+    bool stopping_ = false;
+    // Threads waiting for a TaskGroup, woken by group_wake_.
+    std::condition_variable group_wake_;
+    int waiters_ = 0;
+};
+
+// A set of tasks running on a ThreadPool that can be waited for together.
+// If a task throws, Wait() rethrows the first exception once all tasks have
+// finished. The destructor waits too, but drops the exception.
+//
+// Example:
+//
+// TaskGroup group;
+// group.Run([&]() { left = Solve(a); });
+// group.Run([&]() { right = Solve(b); });
+// group.Wait();
+class TaskGroup {
+   public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::Default()) : pool_(pool) {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    ~TaskGroup() {
+        WaitForTasks();
+    }
+
+    template <typename F>
+    void Run(F&& f) {
+        pending_++;
+        pool_.Push([this, f = std::forward<F>(f)]() mutable {
+            try {
+                f();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+            }
+            // The group may be gone right after this, so it's the last
+            // thing to do.
+            pool_.Finish(pending_);
+        });
+    }
+
+    // Waits until all tasks submitted so far finish, running tasks of the
+    // pool in the meantime. Rethrows the first exception of a task, if any.
+    void Wait() {
+        WaitForTasks();
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(error_mutex_);
+            std::swap(error, error_);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+   private:
+    void WaitForTasks() {
+        while (pending_ > 0) {
+            if (!pool_.RunOne()) {
+                pool_.Sleep(pending_);
+            }
+        }
+    }
+
+    ThreadPool& pool_;
+    std::atomic<int> pending_ = 0;
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+template <typename F>
+void ParallelForImpl(ThreadPool& pool, int begin, int end, int grain, const F& f) {
+    TaskGroup group(pool);
+    // Hand off the upper halves to be stolen, and keep the lowest part.
+    while (end - begin > grain) {
+        int mid = begin + (end - begin) / 2;
+        group.Run([&pool, mid, end, grain, &f]() { ParallelForImpl(pool, mid, end, grain, f); });
+        end = mid;
+    }
+    for (int k = begin; k < end; k++) {
+        f(k);
+    }
+    group.Wait();
+}
+
+// Calls f(k) for every k in [begin, end) in parallel and waits until all
+// calls finish. The range is split in halves recursively, down to chunks of
+// about 1 / (8 * threads) of the range, so that idle threads can steal big
+// pieces of work.
+template <typename F>
+void ParallelFor(int begin, int end, F&& f, ThreadPool& pool = ThreadPool::Default()) {
+    if (begin >= end) {
+        return;
+    }
+    int grain = std::max(1, (end - begin) / (8 * pool.NumThreads()));
+    ParallelForImpl(pool, begin, end, grain, f);
+}
+
+// Calls f(c) for every Coord c in the box in parallel, splitting by rows.
+template <typename F>
+void ParallelFor(const Box& box, F&& f, ThreadPool& pool = ThreadPool::Default()) {
+    ParallelFor(
+        0, box.size_i,
+        [&box, &f](int di) {
+            for (int dj = 0; dj < box.size_j; dj++) {
+                f(Coord{box.min_i + di, box.min_j + dj});
+            }
+        },
+        pool);
+}
+
+// Applies map_fn to every record in parallel and folds the results in order
+// with reduce_fn(accumulator, value) -> accumulator. Runs on the given pool,
+// by default the shared one.
+//
+// Records are split into contiguous chunks whose boundaries depend only on
+// the number of records. Each chunk is folded left to right, then the chunk
+// results are folded left to right. So the answer doesn't depend on the
+// number of threads, and if reduce_fn is associative it is exactly the
+// sequential answer.
+//
+// Returns a value-initialized result if there are no records.
+template <std::ranges::random_access_range Range, typename MapFunc, typename ReduceFunc>
+auto ParallelMapReduce(const Range& records, MapFunc&& map_fn, ReduceFunc&& reduce_fn,
+                       ThreadPool& pool = ThreadPool::Default()) {
+    using Value = std::decay_t<decltype(map_fn(*std::ranges::begin(records)))>;
+    const int kMaxChunks = 1024;
+
+    int size = std::ranges::size(records);
+    int chunk_size = std::max(1, (size + kMaxChunks - 1) / kMaxChunks);
+    int num_chunks = (size + chunk_size - 1) / chunk_size;
+
+    std::vector<std::optional<Value>> chunk_results(num_chunks);
+    ParallelFor(
+        0, num_chunks,
+        [&](int chunk) {
+            auto it = std::ranges::begin(records);
+            int begin = chunk * chunk_size;
+            int end = std::min(size, begin + chunk_size);
+            Value acc = map_fn(it[begin]);
+            for (int k = begin + 1; k < end; k++) {
+                acc = reduce_fn(std::move(acc), map_fn(it[k]));
+            }
+            chunk_results[chunk] = std::move(acc);
+        },
+        pool);
+
+    if (num_chunks == 0) {
+        return Value();
+    }
+    Value result = *std::move(chunk_results[0]);
+    for (int chunk = 1; chunk < num_chunks; chunk++) {
+        result = reduce_fn(std::move(result), *std::move(chunk_results[chunk]));
+    }
+    return result;
+}
+
+#endif
\ No newline at end of file
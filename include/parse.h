@@ -152,9 +152,20 @@ std::string Trim(const std::string& s) {
 // Reads entire text file into a string. Newlines in the output are plain '\n'.
 std::string GetContents(const std::string& filename) {
     std::ifstream f(filename);
-    std::stringstream buffer;
-    buffer << f.rdbuf();
-    return buffer.str();
+    if (!f) {
+        return "";
+    }
+
+    // Read everything with a single read() into a presized buffer. In text
+    // mode the stream may return fewer chars than the file size (e.g. when
+    // it drops '\r'), hence the final resize.
+    f.seekg(0, std::ios::end);
+    std::streamsize size = f.tellg();
+    f.seekg(0, std::ios::beg);
+    std::string result(std::max<std::streamsize>(size, 0), '\0');
+    f.read(result.data(), result.size());
+    result.resize(f.gcount());
+    return result;
 }
 
 #endif
\ No newline at end of file
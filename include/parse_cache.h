@@ -0,0 +1,401 @@
+#ifndef __AOC_PARSE_CACHE_H__
+#define __AOC_PARSE_CACHE_H__
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "parse.h"
+
+// Types whose raw bytes are pointers, which would point nowhere in the next
+// run.
+template <typename T>
+constexpr bool kHoldsPointers = std::is_pointer_v<T> || std::is_member_pointer_v<T>;
+
+template <typename C, typename Traits>
+constexpr bool kHoldsPointers<std::basic_string_view<C, Traits>> = true;
+
+template <typename T, size_t extent>
+constexpr bool kHoldsPointers<std::span<T, extent>> = true;
+
+// Types that are saved as their raw bytes. Structs of plain values qualify
+// too, so a struct that is cached must not contain pointers or views: that
+// can't be told from its type.
+template <typename T>
+concept Blittable =
+    std::is_trivially_copyable_v<T> && !kHoldsPointers<std::remove_all_extents_t<T>>;
+
+// Appends values to a byte buffer. Every array starts at a multiple of its
+// alignment, so that a reader can use it in place.
+class BinaryWriter {
+   public:
+    template <Blittable T>
+    void WriteRaw(const T* data, size_t n) {
+        bytes_.resize((bytes_.size() + alignof(T) - 1) / alignof(T) * alignof(T));
+        const char* begin = reinterpret_cast<const char*>(data);
+        bytes_.append(begin, begin + n * sizeof(T));
+    }
+
+    const std::string& Bytes() const {
+        return bytes_;
+    }
+
+   private:
+    std::string bytes_;
+};
+
+// Reads what BinaryWriter wrote, from memory aligned to at least 8 bytes.
+// Reading past the end or a size that doesn't fit marks the reader as
+// failed instead of dying, so that a damaged file can be ignored.
+class BinaryReader {
+   public:
+    BinaryReader(const std::byte* data, size_t size) : data_(data), size_(size) {}
+
+    // A view of n values in place.
+    template <Blittable T>
+    std::span<const T> ReadRaw(size_t n) {
+        size_t begin = (pos_ + alignof(T) - 1) / alignof(T) * alignof(T);
+        if (failed_ || begin > size_ || n > (size_ - begin) / sizeof(T)) {
+            failed_ = true;
+            return {};
+        }
+        pos_ = begin + n * sizeof(T);
+        return {reinterpret_cast<const T*>(data_ + begin), n};
+    }
+
+    // Marks the data as invalid.
+    void Fail() {
+        failed_ = true;
+    }
+
+    bool Failed() const {
+        return failed_;
+    }
+
+    bool AtEnd() const {
+        return pos_ == size_;
+    }
+
+   private:
+    const std::byte* data_;
+    size_t size_;
+    size_t pos_ = 0;
+    bool failed_ = false;
+};
+
+// How values of T are written and read. Defined below for blittable types,
+// strings, vectors, pairs, tuples and maps of those; specialize it for other
+// types the same way as std::hash.
+template <typename T>
+struct Serializer;
+
+template <typename T>
+    requires Blittable<T>
+struct Serializer<T> {
+    static void Write(BinaryWriter& out, const T& x) {
+        out.WriteRaw(&x, 1);
+    }
+
+    static void Read(BinaryReader& in, T& x) {
+        std::span<const T> s = in.ReadRaw<T>(1);
+        if (!s.empty()) {
+            x = s[0];
+        }
+    }
+};
+
+template <>
+struct Serializer<std::string> {
+    static void Write(BinaryWriter& out, const std::string& s) {
+        uint64_t n = s.size();
+        out.WriteRaw(&n, 1);
+        out.WriteRaw(s.data(), n);
+    }
+
+    static void Read(BinaryReader& in, std::string& s) {
+        std::span<const uint64_t> n = in.ReadRaw<uint64_t>(1);
+        std::span<const char> chars = in.ReadRaw<char>(n.empty() ? 0 : n[0]);
+        s.assign(chars.begin(), chars.end());
+    }
+};
+
+// Arrays of blittable values are copied in one piece.
+template <typename T>
+struct Serializer<std::vector<T>> {
+    static void Write(BinaryWriter& out, const std::vector<T>& v) {
+        uint64_t n = v.size();
+        out.WriteRaw(&n, 1);
+        if constexpr (Blittable<T>) {
+            out.WriteRaw(v.data(), n);
+        } else {
+            for (const T& x : v) {
+                Serializer<T>::Write(out, x);
+            }
+        }
+    }
+
+    static void Read(BinaryReader& in, std::vector<T>& v) {
+        std::span<const uint64_t> n = in.ReadRaw<uint64_t>(1);
+        if (n.empty()) {
+            return;
+        }
+        if constexpr (Blittable<T>) {
+            std::span<const T> data = in.ReadRaw<T>(n[0]);
+            v.assign(data.begin(), data.end());
+        } else {
+            v.clear();
+            for (uint64_t k = 0; k < n[0] && !in.Failed(); k++) {
+                Serializer<T>::Read(in, v.emplace_back());
+            }
+        }
+    }
+};
+
+// A string table: all offsets, then all characters.
+template <>
+struct Serializer<std::vector<std::string>> {
+    static void Write(BinaryWriter& out, const std::vector<std::string>& v) {
+        std::vector<uint64_t> offsets = {0};
+        std::string chars;
+        for (const std::string& s : v) {
+            chars += s;
+            offsets.push_back(chars.size());
+        }
+        Serializer<std::vector<uint64_t>>::Write(out, offsets);
+        out.WriteRaw(chars.data(), chars.size());
+    }
+
+    static void Read(BinaryReader& in, std::vector<std::string>& v) {
+        std::span<const uint64_t> n = in.ReadRaw<uint64_t>(1);
+        std::span<const uint64_t> offsets = in.ReadRaw<uint64_t>(n.empty() ? 0 : n[0]);
+        if (offsets.empty() || !std::is_sorted(offsets.begin(), offsets.end())) {
+            in.Fail();
+            return;
+        }
+        std::span<const char> chars = in.ReadRaw<char>(offsets.back());
+        if (in.Failed()) {
+            return;
+        }
+        v.clear();
+        for (size_t k = 0; k + 1 < offsets.size(); k++) {
+            v.emplace_back(chars.data() + offsets[k], offsets[k + 1] - offsets[k]);
+        }
+    }
+};
+
+template <typename A, typename B>
+struct Serializer<std::pair<A, B>> {
+    static void Write(BinaryWriter& out, const std::pair<A, B>& p) {
+        Serializer<A>::Write(out, p.first);
+        Serializer<B>::Write(out, p.second);
+    }
+
+    static void Read(BinaryReader& in, std::pair<A, B>& p) {
+        Serializer<A>::Read(in, p.first);
+        Serializer<B>::Read(in, p.second);
+    }
+};
+
+template <typename... Ts>
+struct Serializer<std::tuple<Ts...>> {
+    static void Write(BinaryWriter& out, const std::tuple<Ts...>& t) {
+        std::apply([&](const Ts&... xs) { (Serializer<Ts>::Write(out, xs), ...); }, t);
+    }
+
+    static void Read(BinaryReader& in, std::tuple<Ts...>& t) {
+        std::apply([&](Ts&... xs) { (Serializer<Ts>::Read(in, xs), ...); }, t);
+    }
+};
+
+// Maps are saved as vectors of pairs.
+template <typename Map>
+struct MapSerializer {
+    using Pair = std::pair<typename Map::key_type, typename Map::mapped_type>;
+
+    static void Write(BinaryWriter& out, const Map& m) {
+        Serializer<std::vector<Pair>>::Write(out, std::vector<Pair>(m.begin(), m.end()));
+    }
+
+    static void Read(BinaryReader& in, Map& m) {
+        std::vector<Pair> pairs;
+        Serializer<std::vector<Pair>>::Read(in, pairs);
+        m = Map(pairs.begin(), pairs.end());
+    }
+};
+
+template <typename K, typename V, typename... Rest>
+struct Serializer<std::map<K, V, Rest...>> : MapSerializer<std::map<K, V, Rest...>> {};
+
+template <typename K, typename V, typename... Rest>
+struct Serializer<std::unordered_map<K, V, Rest...>>
+    : MapSerializer<std::unordered_map<K, V, Rest...>> {};
+
+// A whole file in memory: mapped where there's mmap(), read otherwise. Empty
+// if the file can't be read.
+class MappedFile {
+   public:
+    explicit MappedFile(const std::string& path) {
+#if __has_include(<sys/mman.h>)
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                mapped_ = static_cast<std::byte*>(p);
+                size_ = st.st_size;
+            }
+        }
+        close(fd);
+#else
+        std::ifstream in(path, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(in)),
+                             std::istreambuf_iterator<char>());
+        // uint64_t for the alignment that BinaryReader needs.
+        buffer_.resize((contents.size() + 7) / 8);
+        std::memcpy(buffer_.data(), contents.data(), contents.size());
+        size_ = contents.size();
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#if __has_include(<sys/mman.h>)
+        if (mapped_ != nullptr) {
+            munmap(mapped_, size_);
+        }
+#endif
+    }
+
+    const std::byte* Data() const {
+        return mapped_ != nullptr ? mapped_ : reinterpret_cast<const std::byte*>(buffer_.data());
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+   private:
+    std::byte* mapped_ = nullptr;
+    std::vector<uint64_t> buffer_;
+    size_t size_ = 0;
+};
+
+// Bump when the layout of the cache files changes.
+constexpr uint32_t kParseCacheFormat = 1;
+
+// What a cache file was made from. Stored at its start.
+struct ParseCacheKey {
+    char magic[8];
+    uint32_t format;
+    uint32_t version;    // The caller's.
+    uint64_t type_hash;  // Of the name of the cached type.
+    uint64_t input_size;
+    int64_t input_mtime;
+    uint64_t input_hash;
+
+    bool operator==(const ParseCacheKey&) const = default;
+};
+
+// FNV-1a.
+inline uint64_t HashBytes(const char* data, size_t n) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t k = 0; k < n; k++) {
+        h = (h ^ (unsigned char)data[k]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+// Returns parse(contents of path), cached in a binary file next to it,
+// path.<name>.cache, so that later runs skip the parsing. T must not contain
+// pointers (see Blittable):
+//
+// std::vector<Brick> bricks = CachedParse<std::vector<Brick>>(
+//     "input.txt", "bricks", 1, [](const std::string& contents) { ... });
+//
+// The cache is used if it was made from an input with the same size,
+// modification time and hash, for the same type and version. Bump the
+// version when the parsing or the layout of T changes. Setting the
+// AOC_PARSE_CACHE environment variable to 0 turns the cache off.
+template <typename T, typename Parse>
+T CachedParse(const std::string& path, const std::string& name, uint32_t version, Parse&& parse) {
+    std::string contents = GetContents(path);
+    const char* enabled = std::getenv("AOC_PARSE_CACHE");
+    if (enabled != nullptr && std::string(enabled) == "0") {
+        return parse(contents);
+    }
+
+    std::error_code error;
+    auto mtime = std::filesystem::last_write_time(path, error);
+    ParseCacheKey key = {{'A', 'O', 'C', 'P', 'A', 'R', 'S', 'E'},
+                         kParseCacheFormat,
+                         version,
+                         HashBytes(typeid(T).name(), std::strlen(typeid(T).name())),
+                         contents.size(),
+                         error ? 0 : (int64_t)mtime.time_since_epoch().count(),
+                         HashBytes(contents.data(), contents.size())};
+    std::string cache_path = path + "." + name + ".cache";
+
+    {
+        MappedFile file(cache_path);
+        BinaryReader in(file.Data(), file.Size());
+        std::span<const ParseCacheKey> stored = in.ReadRaw<ParseCacheKey>(1);
+        if (!stored.empty() && stored[0] == key) {
+            T result;
+            Serializer<T>::Read(in, result);
+            if (!in.Failed() && in.AtEnd()) {
+                return result;
+            }
+        }
+    }
+
+    T result = parse(contents);
+    BinaryWriter out;
+    out.WriteRaw(&key, 1);
+    Serializer<T>::Write(out, result);
+    // Written under another name first, so that a cache file is never seen
+    // half-written, and a name of its own, as other processes may be writing
+    // the same cache. If the directory isn't writable, there's just no cache.
+#if __has_include(<sys/mman.h>)
+    std::string tmp_path = cache_path + "." + std::to_string(getpid()) + ".tmp";
+#else
+    std::string tmp_path = cache_path + "." + std::to_string(std::random_device()()) + ".tmp";
+#endif
+    {
+        std::ofstream tmp(tmp_path, std::ios::binary);
+        tmp.write(out.Bytes().data(), out.Bytes().size());
+    }
+    std::filesystem::rename(tmp_path, cache_path, error);
+    return result;
+}
+
+#endif
\ No newline at end of file
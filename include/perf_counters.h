@@ -0,0 +1,203 @@
+#ifndef __AOC_PERF_COUNTERS_H__
+#define __AOC_PERF_COUNTERS_H__
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware events counted by PerfCounters.
+enum class PerfEvent {
+    kCycles,
+    kInstructions,
+    kL1DMisses,
+    kLLCMisses,
+    kBranchMisses,
+    kDTLBMisses,
+};
+
+constexpr int kNumPerfEvents = 6;
+
+constexpr const char* PerfEventName(PerfEvent event) {
+    constexpr const char* kNames[kNumPerfEvents] = {
+        "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses",
+    };
+    return kNames[(int)event];
+}
+
+// Readings of all counters at some moment. The difference of two readings
+// gives the counts for the code in between:
+//
+// PerfCounters counters;
+// PerfSample before = counters.Read();
+// ...
+// PerfSample region = counters.Read() - before;
+// std::cout << region.Ipc().value_or(0) << std::endl;
+class PerfSample {
+   public:
+    // The count of an event, or nullopt if it couldn't be counted. When the
+    // kernel had to share the hardware counters between events, the count is
+    // extrapolated from the time the event was actually counted.
+    std::optional<double> Get(PerfEvent event) const {
+        const Reading& r = readings_[(int)event];
+        if (!r.valid || r.running == 0) {
+            return std::nullopt;
+        }
+        return (double)r.value * r.enabled / r.running;
+    }
+
+    // Instructions per cycle.
+    std::optional<double> Ipc() const {
+        return Ratio(Get(PerfEvent::kInstructions), Get(PerfEvent::kCycles));
+    }
+
+    // Events per thousand instructions, the usual way to compare miss rates.
+    std::optional<double> PerKiloInstruction(PerfEvent event) const {
+        std::optional<double> ratio = Ratio(Get(event), Get(PerfEvent::kInstructions));
+        if (!ratio.has_value()) {
+            return std::nullopt;
+        }
+        return *ratio * 1000;
+    }
+
+    friend PerfSample operator-(const PerfSample& a, const PerfSample& b) {
+        PerfSample result;
+        for (int k = 0; k < kNumPerfEvents; k++) {
+            const Reading &x = a.readings_[k], &y = b.readings_[k];
+            result.readings_[k] = Reading{x.valid && y.valid, x.value - y.value,
+                                          x.enabled - y.enabled, x.running - y.running};
+        }
+        return result;
+    }
+
+    PerfSample& operator+=(const PerfSample& other) {
+        for (int k = 0; k < kNumPerfEvents; k++) {
+            Reading &x = readings_[k];
+            const Reading& y = other.readings_[k];
+            x = Reading{x.valid && y.valid, x.value + y.value, x.enabled + y.enabled,
+                        x.running + y.running};
+        }
+        return *this;
+    }
+
+    // Prints "name=count" for the events that were counted.
+    friend std::ostream& operator<<(std::ostream& out, const PerfSample& sample) {
+        bool first = true;
+        for (int k = 0; k < kNumPerfEvents; k++) {
+            if (std::optional<double> count = sample.Get(PerfEvent(k))) {
+                out << (first ? "" : " ") << PerfEventName(PerfEvent(k)) << "=" << (uint64_t)*count;
+                first = false;
+            }
+        }
+        return out;
+    }
+
+   private:
+    friend class PerfCounters;
+
+    struct Reading {
+        bool valid = false;
+        uint64_t value = 0;
+        uint64_t enabled = 0;  // Nanoseconds the event was enabled.
+        uint64_t running = 0;  // Nanoseconds it was actually counted.
+    };
+
+    static std::optional<double> Ratio(std::optional<double> a, std::optional<double> b) {
+        if (!a.has_value() || !b.has_value() || *b == 0) {
+            return std::nullopt;
+        }
+        return *a / *b;
+    }
+
+    std::array<Reading, kNumPerfEvents> readings_;
+};
+
+// Hardware performance counters of the calling thread, in user space only,
+// through Linux perf_event_open(). Counting starts in the constructor.
+//
+// Counters that can't be opened (no PMU in a virtual machine, a restrictive
+// kernel.perf_event_paranoid, or not Linux at all) are silently left out:
+// their counts are nullopt, and Available() says if there's any counter at
+// all. Every Read() is a system call per counter, so read around regions
+// that take at least microseconds.
+class PerfCounters {
+   public:
+    PerfCounters() {
+        fds_.fill(-1);
+#ifdef __linux__
+        auto cache = [](uint64_t cache, uint64_t result) {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+        };
+        const std::array<std::pair<uint32_t, uint64_t>, kNumPerfEvents> kConfigs = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+            {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+        }};
+        for (int k = 0; k < kNumPerfEvents; k++) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = kConfigs[k].first;
+            attr.config = kConfigs[k].second;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds_[k] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    bool Available() const {
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Available(PerfEvent event) const {
+        return fds_[(int)event] >= 0;
+    }
+
+    // Counts since the constructor.
+    PerfSample Read() const {
+        PerfSample sample;
+#ifdef __linux__
+        for (int k = 0; k < kNumPerfEvents; k++) {
+            uint64_t data[3];
+            if (fds_[k] >= 0 && read(fds_[k], data, sizeof(data)) == sizeof(data)) {
+                sample.readings_[k] = PerfSample::Reading{true, data[0], data[1], data[2]};
+            }
+        }
+#endif
+        return sample;
+    }
+
+   private:
+    std::array<int, kNumPerfEvents> fds_;
+};
+
+#endif
\ No newline at end of file
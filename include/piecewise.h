@@ -0,0 +1,175 @@
+#ifndef __AOC_PIECEWISE_H__
+#define __AOC_PIECEWISE_H__
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <limits>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "collections.h"
+#include "parse.h"
+
+// A function from T to T that shifts each of finitely many ranges by its own
+// amount and leaves everything else in place, like the almanac maps of AoC
+// 2023/05.
+//
+// The function is stored as a sorted table of breakpoints: piece k starts at
+// Pieces()[k].first and maps x to x + Pieces()[k].second, up to the start of
+// the next piece. The first piece starts at the lowest value of T and has a
+// zero shift. Adjacent pieces always have different shifts, so the table is
+// unique.
+//
+// Example:
+//
+// PiecewiseAffineMap<long long> all;
+// for (const auto& table : tables) {
+//     all = Compose(PiecewiseAffineMap<long long>::Parse(table), all);
+// }
+// long long lowest = *all.MinImage(seeds);
+template <typename T>
+class PiecewiseAffineMap {
+   public:
+    // The identity.
+    PiecewiseAffineMap() : pieces_{{kLowest, T(0)}} {}
+
+    // Shifts each [begin, end) by shift, given as (begin, end, shift) triples.
+    // The ranges must not overlap.
+    explicit PiecewiseAffineMap(std::vector<std::tuple<T, T, T>> ranges) : PiecewiseAffineMap() {
+        std::sort(ranges.begin(), ranges.end());
+        T last_end = kLowest;
+        for (const auto& [begin, end, shift] : ranges) {
+            if (!(begin < end)) {
+                continue;
+            }
+            assert(kLowest < begin && !(begin < last_end));
+            if (last_end < begin) {
+                pieces_.emplace_back(last_end, T(0));
+            }
+            pieces_.emplace_back(begin, shift);
+            last_end = end;
+        }
+        pieces_.emplace_back(last_end, T(0));
+        Normalize();
+    }
+
+    // Parses lines of "destination source length", possibly after a header
+    // line that doesn't start with a digit.
+    static PiecewiseAffineMap Parse(const std::vector<std::string>& lines) {
+        std::vector<std::tuple<T, T, T>> ranges;
+        for (const std::string& line : lines) {
+            if (line.empty() || !std::isdigit(line[0])) {
+                continue;
+            }
+            std::vector<T> v = ParseVector<T>(line);
+            assert(v.size() == 3);
+            ranges.emplace_back(v[1], v[1] + v[2], v[0] - v[1]);
+        }
+        return PiecewiseAffineMap(std::move(ranges));
+    }
+
+    const std::vector<std::pair<T, T>>& Pieces() const {
+        return pieces_;
+    }
+
+    bool operator==(const PiecewiseAffineMap&) const = default;
+
+    T operator()(const T& x) const {
+        return x + pieces_[PieceOf(x)].second;
+    }
+
+    // g(f(x)) as a single table, in time linear in the sizes of both tables
+    // and the result.
+    friend PiecewiseAffineMap Compose(const PiecewiseAffineMap& g, const PiecewiseAffineMap& f) {
+        PiecewiseAffineMap result;
+        result.pieces_.clear();
+        for (int k = 0; k < (int)f.pieces_.size(); k++) {
+            T shift = f.pieces_[k].second;
+            bool last = (k + 1 == (int)f.pieces_.size());
+            // The image of piece k is [begin + shift, end + shift). The lowest
+            // bound is never shifted, to avoid overflows.
+            int j = (k == 0) ? 0 : g.PieceOf(f.pieces_[k].first + shift);
+            result.pieces_.emplace_back(f.pieces_[k].first, shift + g.pieces_[j].second);
+            for (j++; j < (int)g.pieces_.size(); j++) {
+                T begin = g.pieces_[j].first - shift;
+                if (!last && !(begin < f.pieces_[k + 1].first)) {
+                    break;
+                }
+                result.pieces_.emplace_back(begin, shift + g.pieces_[j].second);
+            }
+        }
+        result.Normalize();
+        return result;
+    }
+
+    // The image of a set: the sets of values of every piece are found in one
+    // sweep over both sorted lists, then shifted and merged.
+    IntervalSet<T> Apply(const IntervalSet<T>& set) const {
+        std::vector<std::pair<T, T>> image;
+        Sweep(set, [&](const T& begin, const T& end, const T& shift) {
+            image.emplace_back(begin + shift, end + shift);
+        });
+        return IntervalSet<T>(std::move(image));
+    }
+
+    // The smallest value of the function on a set, or nullopt if the set is
+    // empty.
+    std::optional<T> MinImage(const IntervalSet<T>& set) const {
+        std::optional<T> result;
+        Sweep(set, [&](const T& begin, const T&, const T& shift) {
+            if (!result.has_value() || begin + shift < *result) {
+                result = begin + shift;
+            }
+        });
+        return result;
+    }
+
+    std::optional<T> MinImage(const T& begin, const T& end) const {
+        return MinImage(IntervalSet<T>{{begin, end}});
+    }
+
+   private:
+    static constexpr T kLowest = std::numeric_limits<T>::lowest();
+
+    // Index of the piece containing x.
+    int PieceOf(const T& x) const {
+        auto it = std::upper_bound(pieces_.begin(), pieces_.end(), x,
+                                   [](const T& v, const std::pair<T, T>& p) { return v < p.first; });
+        return (it - pieces_.begin()) - 1;
+    }
+
+    // Calls f(begin, end, shift) for every nonempty intersection [begin, end)
+    // of an interval of the set with a piece.
+    template <typename F>
+    void Sweep(const IntervalSet<T>& set, F&& f) const {
+        int k = 0;
+        for (const auto& [begin, end] : set) {
+            while (k + 1 < (int)pieces_.size() && !(begin < pieces_[k + 1].first)) {
+                k++;
+            }
+            for (int j = k; j < (int)pieces_.size() && pieces_[j].first < end; j++) {
+                T piece_end = (j + 1 < (int)pieces_.size()) ? std::min(end, pieces_[j + 1].first) : end;
+                f(std::max(begin, pieces_[j].first), piece_end, pieces_[j].second);
+            }
+        }
+    }
+
+    // Merges adjacent pieces with equal shifts.
+    void Normalize() {
+        std::vector<std::pair<T, T>> merged;
+        for (const auto& piece : pieces_) {
+            if (merged.empty() || merged.back().second != piece.second) {
+                merged.push_back(piece);
+            }
+        }
+        pieces_ = std::move(merged);
+    }
+
+    std::vector<std::pair<T, T>> pieces_;
+};
+
+#endif
\ No newline at end of file
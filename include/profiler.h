@@ -0,0 +1,305 @@
+#ifndef __AOC_PROFILER_H__
+#define __AOC_PROFILER_H__
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "perf_counters.h"
+
+// Accumulates time spent in nested phases of a program, like "parse" or
+// "search", as a tree: a phase entered while another one is running is its
+// child, and entering the same phase again adds to its total. Phases are
+// usually timed with ScopedTimer below.
+//
+// Time is read from the CPU's timestamp counter where there is one (a few
+// nanoseconds per read), and converted to milliseconds with a rate measured
+// against std::chrono::steady_clock over the lifetime of the profiler.
+//
+// The global profiler reports at exit: to the file named by the AOC_PROFILE
+// environment variable as JSON (see WriteJson()), or otherwise as a tree to
+// stderr, if any phase was timed at all.
+//
+// With EnablePerfCounters(), or the AOC_PERF environment variable for the
+// global profiler, every phase also collects hardware counters (see
+// perf_counters.h), reported as instructions per cycle and misses per
+// thousand instructions. That costs a few system calls per phase.
+//
+// Not thread-safe: time phases on the main thread only.
+class PhaseProfiler {
+   public:
+    // One phase in the flattened tree.
+    struct Phase {
+        std::string path;  // Names from the top, like "search/expand".
+        int depth;         // 1 for the top-level phases.
+        double ms;
+        double self_ms;    // Excluding the children.
+        long long calls;
+        PerfSample perf;   // Empty unless perf counters are enabled.
+    };
+
+    PhaseProfiler() : PhaseProfiler(false) {}
+
+    PhaseProfiler(const PhaseProfiler&) = delete;
+    PhaseProfiler& operator=(const PhaseProfiler&) = delete;
+
+    ~PhaseProfiler() {
+        if (!report_at_exit_ || nodes_.size() == 1) {
+            return;
+        }
+        if (const char* path = std::getenv("AOC_PROFILE"); path != nullptr && *path != 0) {
+            std::ofstream out(path);
+            WriteJson(out);
+        } else {
+            Report(std::cerr);
+        }
+    }
+
+    // Starts collecting hardware counters for the phases entered from now
+    // on. Returns false, and changes nothing, if there are no counters.
+    bool EnablePerfCounters() {
+        auto perf = std::make_unique<PerfCounters>();
+        if (!perf->Available()) {
+            return false;
+        }
+        perf_ = std::move(perf);
+        return true;
+    }
+
+    static PhaseProfiler& Global() {
+        static PhaseProfiler profiler(true);
+        return profiler;
+    }
+
+    // Starts the phase called name within the current one.
+    void Enter(std::string_view name) {
+        int child = -1;
+        for (int c : nodes_[current_].children) {
+            if (nodes_[c].name == name) {
+                child = c;
+                break;
+            }
+        }
+        if (child < 0) {
+            child = nodes_.size();
+            nodes_.push_back(Node{std::string(name), current_});
+            nodes_[current_].children.push_back(child);
+        }
+        Node& node = nodes_[child];
+        current_ = child;
+        if (perf_) {
+            node.perf_entered = perf_->Read();
+            if (node.calls == 0) {
+                // Counts of the same events, all zero.
+                node.perf = node.perf_entered - node.perf_entered;
+            }
+        }
+        node.calls++;
+        node.entered = Ticks();
+    }
+
+    // Ends the current phase.
+    void Leave() {
+        assert(current_ != 0);
+        Node& node = nodes_[current_];
+        node.ticks += Ticks() - node.entered;
+        if (perf_) {
+            node.perf += perf_->Read() - node.perf_entered;
+        }
+        current_ = node.parent;
+    }
+
+    // Time since the profiler was created.
+    double TotalMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                         start_time_)
+            .count();
+    }
+
+    // All phases, every parent before its children, which are in the order
+    // they were first entered. Phases that are still running only count their
+    // completed calls.
+    std::vector<Phase> Phases() const {
+        std::vector<Phase> result;
+        Flatten(0, "", 0, MsPerTick(), result);
+        return result;
+    }
+
+    // Prints the tree with times, shares of the total and numbers of calls.
+    void Report(std::ostream& out) const {
+        double total = TotalMs();
+        out << std::left << std::setw(32) << "phase" << std::right << std::setw(12) << "ms"
+            << std::setw(8) << "%" << std::setw(12) << "self ms" << std::setw(12) << "calls";
+        if (perf_) {
+            out << std::setw(8) << "IPC" << std::setw(9) << "L1D/ki" << std::setw(9) << "LLC/ki"
+                << std::setw(9) << "br/ki" << std::setw(9) << "dTLB/ki";
+        }
+        out << std::endl;
+        out << std::fixed << std::setprecision(1);
+        out << std::left << std::setw(32) << "(total)" << std::right << std::setw(12) << total
+            << std::setw(8) << 100.0 << std::endl;
+        for (const Phase& phase : Phases()) {
+            std::string name = phase.path.substr(phase.path.rfind('/') + 1);
+            out << std::left << std::setw(32) << std::string(2 * phase.depth, ' ') + name
+                << std::right << std::setw(12) << phase.ms << std::setw(8)
+                << (total > 0 ? phase.ms / total * 100 : 0) << std::setw(12) << phase.self_ms
+                << std::setw(12) << phase.calls;
+            if (perf_) {
+                auto print = [&](int width, std::optional<double> x) {
+                    out << std::setw(width);
+                    if (x.has_value()) {
+                        out << *x;
+                    } else {
+                        out << "-";
+                    }
+                };
+                out << std::setprecision(2);
+                print(8, phase.perf.Ipc());
+                for (PerfEvent event : {PerfEvent::kL1DMisses, PerfEvent::kLLCMisses,
+                                        PerfEvent::kBranchMisses, PerfEvent::kDTLBMisses}) {
+                    print(9, phase.perf.PerKiloInstruction(event));
+                }
+                out << std::setprecision(1);
+            }
+            out << std::endl;
+        }
+    }
+
+    // Writes {"total_ms": ..., "phases": [...]} with one phase object per
+    // line, in the order of Phases(), so that the bench driver can read it
+    // without a JSON parser. Counted hardware events are added to the phases
+    // as "cycles": ... and so on.
+    void WriteJson(std::ostream& out) const {
+        out << std::fixed << std::setprecision(3);
+        out << "{\"total_ms\": " << TotalMs() << ", \"phases\": [";
+        std::vector<Phase> phases = Phases();
+        for (int i = 0; i < (int)phases.size(); i++) {
+            const Phase& phase = phases[i];
+            out << (i == 0 ? "\n" : ",\n") << "{\"path\": \"" << Escape(phase.path)
+                << "\", \"depth\": " << phase.depth << ", \"ms\": " << phase.ms
+                << ", \"self_ms\": " << phase.self_ms << ", \"calls\": " << phase.calls;
+            for (int k = 0; k < kNumPerfEvents; k++) {
+                if (std::optional<double> count = phase.perf.Get(PerfEvent(k))) {
+                    out << ", \"" << PerfEventName(PerfEvent(k)) << "\": " << (uint64_t)*count;
+                }
+            }
+            out << "}";
+        }
+        out << "\n]}" << std::endl;
+    }
+
+   private:
+    struct Node {
+        std::string name;
+        int parent;
+        std::vector<int> children;
+        uint64_t ticks = 0;
+        uint64_t entered = 0;
+        long long calls = 0;
+        PerfSample perf;
+        PerfSample perf_entered;
+    };
+
+    explicit PhaseProfiler(bool report_at_exit)
+        : report_at_exit_(report_at_exit),
+          start_ticks_(Ticks()),
+          start_time_(std::chrono::steady_clock::now()) {
+        nodes_.push_back(Node{"", -1});
+        const char* perf = std::getenv("AOC_PERF");
+        if (report_at_exit && perf != nullptr && *perf != 0) {
+            EnablePerfCounters();
+        }
+    }
+
+    static uint64_t Ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+#endif
+    }
+
+    double MsPerTick() const {
+        uint64_t ticks = Ticks() - start_ticks_;
+        return ticks == 0 ? 0 : TotalMs() / ticks;
+    }
+
+    static std::string Escape(const std::string& s) {
+        std::string result;
+        for (char c : s) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+            }
+            result += (c == '\n' || c == '\t') ? ' ' : c;
+        }
+        return result;
+    }
+
+    void Flatten(int node, const std::string& path, int depth, double ms_per_tick,
+                 std::vector<Phase>& result) const {
+        for (int c : nodes_[node].children) {
+            const Node& child = nodes_[c];
+            std::string child_path = path.empty() ? child.name : path + "/" + child.name;
+            uint64_t children_ticks = 0;
+            for (int g : child.children) {
+                children_ticks += nodes_[g].ticks;
+            }
+            result.push_back(Phase{child_path, depth + 1, child.ticks * ms_per_tick,
+                                   (child.ticks - std::min(child.ticks, children_ticks)) *
+                                       ms_per_tick,
+                                   child.calls, child.perf});
+            Flatten(c, child_path, depth + 1, ms_per_tick, result);
+        }
+    }
+
+    std::vector<Node> nodes_;  // nodes_[0] is the root, which is never timed.
+    int current_ = 0;
+    // Only for Global().
+    bool report_at_exit_;
+    std::unique_ptr<PerfCounters> perf_;
+    uint64_t start_ticks_;
+    std::chrono::steady_clock::time_point start_time_;
+};
+
+// Times a scope as a phase of the global profiler (or of another one):
+//
+// {
+//     ScopedTimer timer("parse");
+//     ...
+// }
+class ScopedTimer {
+   public:
+    explicit ScopedTimer(std::string_view name,
+                         PhaseProfiler& profiler = PhaseProfiler::Global())
+        : profiler_(profiler) {
+        profiler_.Enter(name);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        profiler_.Leave();
+    }
+
+   private:
+    PhaseProfiler& profiler_;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,209 @@
+#ifndef __AOC_SEQUENCE_H__
+#define __AOC_SEQUENCE_H__
+
+#include <cassert>
+#include <concepts>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "numbers.h"
+
+// A rule that extends a sequence given by a prefix of its terms: either a
+// polynomial in the index, or a linear recurrence with constant coefficients.
+//
+// Arithmetic is exact, so T should be an integer type (polynomials only),
+// Rational, BigRat or ModInt.
+//
+// Example:
+//
+// auto squares = SequenceModel<long long>::Fit({0, 1, 4, 9});
+// assert(squares->At(1000) == 1000000);
+template <typename T>
+class SequenceModel {
+   public:
+    // Fits a polynomial of the smallest degree d that matches the terms, by
+    // finite differences computed in place. Returns nullopt unless there's at
+    // least one term more than needed to determine the polynomial, i.e. unless
+    // d + 2 <= terms.size().
+    static std::optional<SequenceModel> FitPolynomial(std::vector<T> terms) {
+        int m = terms.size();
+        // Before step k, terms[k..m) hold the k-th differences, and terms[0..k)
+        // the leading differences of lower orders.
+        for (int k = 0; k < m; k++) {
+            bool all_zero = true;
+            for (int i = k; i < m && all_zero; i++) {
+                all_zero = (terms[i] == T(0));
+            }
+            if (all_zero) {
+                terms.resize(k);
+                return SequenceModel(true, std::move(terms), {});
+            }
+            for (int i = m - 1; i > k; i--) {
+                terms[i] -= terms[i - 1];
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Finds the shortest linear recurrence a[i] = c[1] * a[i - 1] + ... +
+    // c[L] * a[i - L] that generates the terms (Berlekamp-Massey). Returns
+    // nullopt if there are fewer than 2 * L terms, which is too few to tell.
+    static std::optional<SequenceModel> FitRecurrence(const std::vector<T>& terms)
+        requires(!std::integral<T>)
+    {
+        // connection is the polynomial 1 - c[1] x - ... - c[L] x^L, and
+        // previous is its value before the last change of L.
+        std::vector<T> connection = {T(1)}, previous = {T(1)};
+        int length = 0, shift = 1;
+        T previous_discrepancy = T(1);
+        for (int n = 0; n < (int)terms.size(); n++) {
+            T discrepancy = terms[n];
+            for (int i = 1; i <= length; i++) {
+                discrepancy += connection[i] * terms[n - i];
+            }
+            if (discrepancy == T(0)) {
+                shift++;
+                continue;
+            }
+
+            std::vector<T> saved = connection;
+            T coef = discrepancy / previous_discrepancy;
+            if (connection.size() < previous.size() + shift) {
+                connection.resize(previous.size() + shift, T(0));
+            }
+            for (int i = 0; i < (int)previous.size(); i++) {
+                connection[i + shift] -= coef * previous[i];
+            }
+            if (2 * length <= n) {
+                length = n + 1 - length;
+                previous = std::move(saved);
+                previous_discrepancy = discrepancy;
+                shift = 1;
+            } else {
+                shift++;
+            }
+        }
+
+        if (2 * length > (int)terms.size()) {
+            return std::nullopt;
+        }
+        std::vector<T> coefs(length);
+        for (int i = 1; i <= length; i++) {
+            coefs[i - 1] = (i < (int)connection.size()) ? -connection[i] : T(0);
+        }
+        return SequenceModel(false, std::move(coefs),
+                             std::vector<T>(terms.begin(), terms.begin() + length));
+    }
+
+    // A polynomial if one fits, or else a linear recurrence.
+    static std::optional<SequenceModel> Fit(const std::vector<T>& terms) {
+        std::optional<SequenceModel> result = FitPolynomial(terms);
+        if constexpr (!std::integral<T>) {
+            if (!result.has_value()) {
+                result = FitRecurrence(terms);
+            }
+        }
+        return result;
+    }
+
+    bool IsPolynomial() const {
+        return polynomial_;
+    }
+
+    // Degree of the polynomial plus one, or the length of the recurrence:
+    // the number of coefficients either way.
+    int Size() const {
+        return coefs_.size();
+    }
+
+    // For a polynomial, its leading differences: the term with index n is
+    // the sum of coefs[k] * Binomial(n, k). For a recurrence, c[1..L].
+    const std::vector<T>& Coefficients() const {
+        return coefs_;
+    }
+
+    // The term with index n. A polynomial can be evaluated at any n, including
+    // negative ones, in O(degree). A recurrence needs n >= 0 and takes
+    // O(L^2 log n) by computing x^n modulo its characteristic polynomial.
+    T At(long long n) const {
+        return polynomial_ ? PolynomialAt(n) : RecurrenceAt(n);
+    }
+
+   private:
+    SequenceModel(bool polynomial, std::vector<T> coefs, std::vector<T> initial)
+        : polynomial_(polynomial), coefs_(std::move(coefs)), initial_(std::move(initial)) {}
+
+    // Newton's forward difference formula. Binomial(n, k) is updated one k at
+    // a time, and the divisions are exact.
+    T PolynomialAt(long long n) const {
+        using W = Wide<T>;
+        W result = 0, binomial = 1;
+        for (int k = 0; k < (int)coefs_.size(); k++) {
+            result += (W)coefs_[k] * binomial;
+            binomial = binomial * (W)(n - k) / (W)(k + 1);
+        }
+        if constexpr (std::integral<T>) {
+            assert(FitsInto<T>(result));
+        }
+        return static_cast<T>(result);
+    }
+
+    T RecurrenceAt(long long n) const {
+        assert(n >= 0);
+        int length = coefs_.size();
+        if (length == 0) {
+            return T(0);
+        }
+        if (n < length) {
+            return initial_[n];
+        }
+
+        // Polynomials of degree < length modulo x^length = c[1] x^(length - 1)
+        // + ... + c[length].
+        auto mul_mod = [&](const std::vector<T>& a, const std::vector<T>& b) {
+            std::vector<T> product(2 * length - 1, T(0));
+            for (int i = 0; i < length; i++) {
+                for (int j = 0; j < length; j++) {
+                    product[i + j] += a[i] * b[j];
+                }
+            }
+            for (int k = 2 * length - 2; k >= length; k--) {
+                for (int j = 1; j <= length; j++) {
+                    product[k - j] += product[k] * coefs_[j - 1];
+                }
+            }
+            product.resize(length);
+            return product;
+        };
+
+        std::vector<T> result(length, T(0)), power(length, T(0));
+        result[0] = T(1);
+        if (length == 1) {
+            power[0] = coefs_[0];
+        } else {
+            power[1] = T(1);
+        }
+        for (; n > 0; n >>= 1) {
+            if (n & 1) {
+                result = mul_mod(result, power);
+            }
+            if (n > 1) {
+                power = mul_mod(power, power);
+            }
+        }
+
+        T term = T(0);
+        for (int i = 0; i < length; i++) {
+            term += result[i] * initial_[i];
+        }
+        return term;
+    }
+
+    bool polynomial_;
+    std::vector<T> coefs_;
+    // First terms of the sequence, for recurrences.
+    std::vector<T> initial_;
+};
+
+#endif
\ No newline at end of file
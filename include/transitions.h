@@ -0,0 +1,165 @@
+#ifndef __AOC_TRANSITIONS_H__
+#define __AOC_TRANSITIONS_H__
+
+#include <cassert>
+#include <cmath>
+#include <ranges>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "linalg.h"
+
+// A linear evolution of counts over a finite set of states: at every step,
+// each item in some state turns into items in successor states. Think of
+// stones that split, or probabilities in a Markov chain.
+//
+// The constructor discovers all states reachable from the starting ones.
+// rule(transitions, state) must call transitions.Add(next, weight) for every
+// successor of the state; adding the same successor twice adds up weights.
+// States get dense ids in the order of discovery, and the transitions are
+// stored as a sparse matrix in the CSR format.
+//
+// Count is the type of the counts and weights, e.g. long long or ModInt.
+//
+// Example:
+//
+// TransitionSystem<long long> stones(xs, [](auto& t, long long x) {
+//     t.Add(x / 2);
+//     t.Add(x % 2);
+// });
+// std::vector<long long> counts = stones.Advance(stones.Counts(xs), 75);
+template <typename State, typename Count = long long, typename Hasher = std::hash<State>>
+class TransitionSystem {
+   public:
+    static_assert(!std::is_same_v<State, bool>);
+
+    template <std::ranges::input_range Range, typename RuleFunc>
+    TransitionSystem(const Range& starts, RuleFunc&& rule) {
+        for (const State& s : starts) {
+            Intern(s);
+        }
+        // states_ grows while we walk it, so no references into it.
+        for (int id = 0; id < (int)states_.size(); id++) {
+            row_begin_.push_back(targets_.size());
+            State s = states_[id];
+            rule(*this, s);
+        }
+        row_begin_.push_back(targets_.size());
+    }
+
+    TransitionSystem(const TransitionSystem&) = delete;
+    TransitionSystem& operator=(const TransitionSystem&) = delete;
+
+    // Called by the rule: the state being expanded turns into `next`, with the
+    // given multiplicity.
+    void Add(const State& next, const Count& weight = Count(1)) {
+        targets_.push_back(Intern(next));
+        weights_.push_back(weight);
+    }
+
+    int NumStates() const {
+        return states_.size();
+    }
+
+    int NumTransitions() const {
+        return targets_.size();
+    }
+
+    // Dense id of a state. Dies if the state is not reachable.
+    int Id(const State& s) const {
+        auto it = ids_.find(s);
+        assert(it != ids_.end());
+        return it->second;
+    }
+
+    const State& GetState(int id) const {
+        return states_[id];
+    }
+
+    // Count vector with one item per element of the range.
+    template <std::ranges::input_range Range>
+    std::vector<Count> Counts(const Range& states) const {
+        std::vector<Count> counts(NumStates(), Count(0));
+        for (const State& s : states) {
+            counts[Id(s)] += Count(1);
+        }
+        return counts;
+    }
+
+    // One step: multiplication by the sparse transition matrix.
+    std::vector<Count> Step(const std::vector<Count>& counts) const {
+        assert((int)counts.size() == NumStates());
+        std::vector<Count> next(NumStates(), Count(0));
+        for (int from = 0; from < NumStates(); from++) {
+            const Count& c = counts[from];
+            if (c == Count(0)) {
+                continue;
+            }
+            for (int e = row_begin_[from]; e < row_begin_[from + 1]; e++) {
+                next[targets_[e]] += c * weights_[e];
+            }
+        }
+        return next;
+    }
+
+    // The counts after the given number of steps. Uses repeated squaring of
+    // the dense transition matrix when that is cheaper than stepping, i.e.
+    // when the number of steps is large compared to the number of states.
+    std::vector<Count> Advance(std::vector<Count> counts, long long steps) const {
+        assert(steps >= 0);
+        double n = NumStates();
+        double stepping_cost = (double)steps * (NumTransitions() + n);
+        double squaring_cost = n * n * n * std::log2(steps + 1.0);
+        if (stepping_cost <= squaring_cost) {
+            for (long long k = 0; k < steps; k++) {
+                counts = Step(counts);
+            }
+            return counts;
+        }
+
+        Matrix<Count> power = DenseMatrix();
+        while (steps > 0) {
+            if (steps & 1) {
+                counts = power * counts;
+            }
+            steps >>= 1;
+            if (steps > 0) {
+                power = power * power;
+            }
+        }
+        return counts;
+    }
+
+    // The transition matrix, with m[to][from] being the weight of the
+    // transition, so that it multiplies column vectors of counts.
+    Matrix<Count> DenseMatrix() const {
+        Matrix<Count> m(NumStates(), NumStates());
+        for (int from = 0; from < NumStates(); from++) {
+            for (int e = row_begin_[from]; e < row_begin_[from + 1]; e++) {
+                m[targets_[e]][from] += weights_[e];
+            }
+        }
+        return m;
+    }
+
+   private:
+    int Intern(const State& s) {
+        auto [it, inserted] = ids_.insert(std::make_pair(s, (int)states_.size()));
+        if (inserted) {
+            states_.push_back(s);
+        }
+        return it->second;
+    }
+
+    std::unordered_map<State, int, Hasher> ids_;
+    std::vector<State> states_;
+
+    // Transitions from state `from` are at [row_begin_[from], row_begin_[from + 1]).
+    std::vector<int> row_begin_;
+    std::vector<int> targets_;
+    std::vector<Count> weights_;
+};
+
+#endif
\ No newline at end of file
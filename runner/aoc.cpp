@@ -0,0 +1,295 @@
+// One binary with all solutions linked in.
+//
+// Usage:
+//
+// aoc list
+// aoc run 2024/16/b [--input PATH]
+// aoc run-all [-j N] [PREFIX...]
+//
+// `run` runs one solution in its own directory, or with PATH as its
+// input.txt, and prints the time it took to stderr.
+//
+// `run-all` runs every solution whose name starts with one of the prefixes
+// (all of them by default) in a child process, N at a time (the number of
+// cores by default). It prints the last line of every answer and the time of
+// every solution, so the whole run takes about as long as the slowest one.
+//
+// Needs a POSIX system.
+
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "parse.h"
+#include "registry.h"
+
+namespace fs = std::filesystem;
+
+// The Windows build gives solutions this much stack through the linker.
+const rlim_t kStackBytes = 256000000;
+
+using Clock = std::chrono::steady_clock;
+
+double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+const RegisteredSolution* FindSolution(std::string name) {
+    std::replace(name.begin(), name.end(), '_', '/');
+    for (int i = 0; i < kRegistrySize; i++) {
+        std::string candidate = kRegistry[i].name;
+        std::replace(candidate.begin(), candidate.end(), '_', '/');
+        if (candidate == name) {
+            return &kRegistry[i];
+        }
+    }
+    return nullptr;
+}
+
+// Deep recursion in some solutions needs a large stack. The limit only takes
+// full effect for a new program, so raise it and start over, once: the hard
+// limit may not let it go any higher.
+void EnsureLargeStack(char* argv[]) {
+    rlimit stack;
+    if (std::getenv("AOC_STACK_RAISED") != nullptr || getrlimit(RLIMIT_STACK, &stack) != 0 ||
+        stack.rlim_cur == RLIM_INFINITY ||
+        stack.rlim_cur >= std::min<rlim_t>(kStackBytes, stack.rlim_max)) {
+        return;
+    }
+    stack.rlim_cur = std::min(kStackBytes, stack.rlim_max);
+    if (setrlimit(RLIMIT_STACK, &stack) == 0 && setenv("AOC_STACK_RAISED", "1", 1) == 0) {
+        execv("/proc/self/exe", argv);
+        // If that didn't work, go on with the stack we have.
+    }
+}
+
+int Run(const RegisteredSolution& s, const std::string& input) {
+    fs::path dir = s.dir;
+    if (!input.empty()) {
+        // Solutions read input.txt from the current directory, so give them
+        // a directory where it's a link to the given file.
+        std::string tmp = (fs::temp_directory_path() / "aoc.XXXXXX").string();
+        if (mkdtemp(tmp.data()) == nullptr) {
+            perror("mkdtemp");
+            return 1;
+        }
+        dir = tmp;
+        fs::create_symlink(fs::absolute(input), dir / "input.txt");
+    }
+    fs::current_path(dir);
+
+    Clock::time_point start = Clock::now();
+    int status = s.main();
+    std::cout.flush();
+    std::cerr << s.name << ": " << std::fixed << std::setprecision(1) << MsSince(start) << " ms"
+              << std::endl;
+    if (!input.empty()) {
+        fs::remove_all(dir);
+    }
+    return status;
+}
+
+struct Job {
+    const RegisteredSolution* solution;
+    FILE* output;
+    Clock::time_point start;
+    double wall_ms = 0;
+    double cpu_ms = 0;
+    int status = 0;
+};
+
+// Starts the solution in a child process with stdout going to a temporary
+// file.
+pid_t Start(Job& job) {
+    job.output = std::tmpfile();
+    if (job.output == nullptr) {
+        perror("tmpfile");
+        exit(1);
+    }
+    std::cout.flush();
+    job.start = Clock::now();
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(fileno(job.output), STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        close(null_fd);
+        if (chdir(job.solution->dir) != 0) {
+            _exit(126);
+        }
+        int status = job.solution->main();
+        std::cout.flush();
+        fflush(stdout);
+        _exit(status);
+    }
+    return pid;
+}
+
+// Last nonempty line of the output.
+std::string Answer(FILE* output) {
+    std::string text;
+    rewind(output);
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), output)) > 0) {
+        text.append(buffer, n);
+    }
+    fclose(output);
+    std::vector<std::string> lines = Split(Trim(text), "\n");
+    return lines.back();
+}
+
+int RunAll(int jobs, const std::vector<std::string>& prefixes) {
+    std::vector<Job> queue;
+    for (int i = 0; i < kRegistrySize; i++) {
+        std::string name = kRegistry[i].name;
+        bool selected = prefixes.empty() ||
+                        std::any_of(prefixes.begin(), prefixes.end(),
+                                    [&](const std::string& p) { return name.starts_with(p); });
+        if (selected && fs::exists(fs::path(kRegistry[i].dir) / "input.txt")) {
+            queue.push_back(Job{.solution = &kRegistry[i]});
+        }
+    }
+
+    Clock::time_point start = Clock::now();
+    std::map<pid_t, int> running;
+    int next = 0, failed = 0;
+    double total_ms = 0;
+    std::cout << std::left << std::setw(14) << "solution" << std::right << std::setw(11)
+              << "wall ms" << std::setw(11) << "cpu ms" << "  answer" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    while (next < (int)queue.size() || !running.empty()) {
+        while (next < (int)queue.size() && (int)running.size() < jobs) {
+            running[Start(queue[next])] = next;
+            next++;
+        }
+
+        int wstatus;
+        rusage usage;
+        pid_t pid = wait4(-1, &wstatus, 0, &usage);
+        if (pid < 0) {
+            perror("wait4");
+            exit(1);
+        }
+        auto it = running.find(pid);
+        if (it == running.end()) {
+            continue;
+        }
+        Job& job = queue[it->second];
+        running.erase(it);
+        job.wall_ms = MsSince(job.start);
+        job.cpu_ms = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+                     (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+        job.status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128 + WTERMSIG(wstatus);
+        total_ms += job.wall_ms;
+
+        std::string answer = Answer(job.output);
+        if (job.status != 0) {
+            answer = "FAILED with status " + std::to_string(job.status);
+            failed++;
+        } else if (answer.size() > 60) {
+            answer = answer.substr(0, 57) + "...";
+        }
+        std::cout << std::left << std::setw(14) << job.solution->name << std::right
+                  << std::setw(11) << job.wall_ms << std::setw(11) << job.cpu_ms << "  "
+                  << answer << std::endl;
+    }
+
+    std::cout << queue.size() << " solutions, " << failed << " failed, " << MsSince(start)
+              << " ms with " << jobs << " jobs (" << total_ms << " ms one by one)" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
+
+// A number of jobs, or 0 if the argument isn't a positive integer.
+int ParseJobs(const std::string& arg) {
+    int jobs = 0;
+    auto [end, error] = std::from_chars(arg.data(), arg.data() + arg.size(), jobs);
+    if (error != std::errc() || end != arg.data() + arg.size() || jobs < 1) {
+        return 0;
+    }
+    return jobs;
+}
+
+int Usage() {
+    std::cerr << "Usage: aoc list | run YEAR/DAY/PART [--input PATH] | run-all [-j N] [PREFIX...]"
+              << std::endl;
+    return 2;
+}
+
+int main(int argc, char* argv[]) {
+    EnsureLargeStack(argv);
+    if (argc < 2) {
+        return Usage();
+    }
+    std::string command = argv[1];
+
+    if (command == "list") {
+        for (int i = 0; i < kRegistrySize; i++) {
+            std::cout << kRegistry[i].name << std::endl;
+        }
+        return 0;
+    }
+
+    if (command == "run") {
+        if (argc < 3) {
+            return Usage();
+        }
+        const RegisteredSolution* s = FindSolution(argv[2]);
+        if (s == nullptr) {
+            std::cerr << "No such solution: " << argv[2] << std::endl;
+            return 2;
+        }
+        std::string input;
+        for (int i = 3; i < argc; i++) {
+            if (std::string(argv[i]) == "--input" && i + 1 < argc) {
+                input = argv[++i];
+            } else {
+                return Usage();
+            }
+        }
+        return Run(*s, input);
+    }
+
+    if (command == "run-all") {
+        int jobs = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::string> prefixes;
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.starts_with("-j")) {
+                // Either "-j N" or "-jN".
+                std::string value = arg.substr(2);
+                if (value.empty() && i + 1 < argc) {
+                    value = argv[++i];
+                }
+                jobs = ParseJobs(value);
+                if (jobs == 0) {
+                    return Usage();
+                }
+            } else {
+                prefixes.push_back(arg);
+            }
+        }
+        return RunAll(jobs, prefixes);
+    }
+    return Usage();
+}
\ No newline at end of file
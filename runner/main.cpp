@@ -0,0 +1,8 @@
+// main() of the standalone executable of a solution. The solution's own
+// main() is compiled under the name AOC_MAIN, so that the same object can
+// also be linked into the `aoc` runner (see CMakeLists.txt).
+int AOC_MAIN();
+
+int main() {
+    return AOC_MAIN();
+}
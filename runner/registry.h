@@ -0,0 +1,18 @@
+#ifndef __AOC_REGISTRY_H__
+#define __AOC_REGISTRY_H__
+
+// A solution linked into the `aoc` runner.
+struct RegisteredSolution {
+    // Like "2024/16/b".
+    const char* name;
+    // Directory with its input.txt.
+    const char* dir;
+    // The solution's main(), renamed.
+    int (*main)();
+};
+
+// All solutions, sorted by name. Generated by CMake from registry.cpp.in.
+extern const RegisteredSolution kRegistry[];
+extern const int kRegistrySize;
+
+#endif
\ No newline at end of file
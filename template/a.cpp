@@ -11,12 +11,22 @@
 #include <utility>
 #include <vector>
 
+#include "arena.h"
+#include "bigint.h"
 #include "collections.h"
 #include "graph_search.h"
 #include "grid.h"
+#include "linalg.h"
 #include "numbers.h"
 #include "order.h"
+#include "parallel.h"
 #include "parse.h"
+#include "parse_cache.h"
+#include "perf_counters.h"
+#include "piecewise.h"
+#include "profiler.h"
+#include "sequence.h"
+#include "transitions.h"
 
 int main() {
     std::vector<std::string> input = Split(Trim(GetContents("input.txt")), "\n");
@@ -2,18 +2,39 @@
 #include <cassert>
 #include <cmath>
 #include <concepts>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory_resource>
 #include <optional>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
 
+#include "arena.h"
+#include "bigint.h"
 #include "collections.h"
 #include "graph_search.h"
 #include "grid.h"
+#include "linalg.h"
 #include "numbers.h"
 #include "order.h"
+#include "parallel.h"
 #include "parse.h"
+#include "parse_cache.h"
+#include "perf_counters.h"
+#include "piecewise.h"
+#include "profiler.h"
+#include "sequence.h"
+#include "transitions.h"
 
 template <typename F>
 constexpr long double kEpsilon;
@@ -27,8 +48,8 @@ constexpr long double kEpsilon<double> = 1e-13;
 template <>
 constexpr long double kEpsilon<long double> = 0;
 
-template <typename T>
-bool Near(Rational<T> r, long double v) {
+template <typename T, bool kLazy>
+bool Near(Rational<T, kLazy> r, long double v) {
     long double rd = static_cast<long double>(r.Num()) /
                      static_cast<long double>(r.Denom());
     return abs(rd - v) <= 1e-16;
@@ -335,6 +356,319 @@ void TestDijkstra() {
     assert(result == dist);
 }
 
+void TestSearchStats() {
+    std::vector<SearchStats> reports;
+    auto saved_reporter = SearchStats::reporter;
+    SearchStats::reporter = [&](const SearchStats& stats) { reports.push_back(stats); };
+
+    std::unordered_map<char, std::vector<char>> graph = {
+        {'a', {'b', 'c'}},
+        {'b', {'c', 'd'}},
+        {'c', {'d'}},
+        {'d', {'a'}},
+        {'e', {'a', 'f'}},
+        {'f', {'g', 'h'}},
+    };
+    DFSFrom<char, std::hash<char>, SearchStats>(std::string("abcdefgh"), [&](auto& search, char u) {
+        assert(search.GetStats().visits == u - 'a' + 1);
+        for (char v : graph[u]) {
+            search.Look(v);
+        }
+    });
+    assert(reports.size() == 1);
+    assert(std::string(reports[0].engine) == "DFS");
+    assert(reports[0].visits == 8);
+    assert((reports[0].dfs_looks == std::array<long long, 4>{8, 1, 8, 1}));
+    assert(reports[0].pushes == 8 && reports[0].pops == 8);
+    assert(reports[0].max_frontier == 4);
+
+    BFSFrom<int, std::hash<int>, SearchStats>(0, [](auto& search, int x) {
+        for (int y : {x - 1, x + 1}) {
+            if (y >= 0 && y < 10) {
+                search.Look(y);
+            }
+        }
+    });
+    assert(reports.size() == 2);
+    assert(reports[1].visits == 10);
+    assert((reports[1].bfs_looks == std::array<long long, 3>{10, 0, 9}));
+    assert(reports[1].max_frontier == 1);
+
+    std::unordered_map<std::string, std::vector<std::pair<std::string, int>>> weighted = {
+        {"s", {{"x", 5}, {"u", 10}}},
+        {"x", {{"u", 3}, {"y", 2}, {"v", 9}}},
+        {"u", {{"x", 2}, {"v", 1}}},
+        {"y", {{"s", 7}, {"v", 6}}},
+        {"v", {{"y", 4}}},
+    };
+    DijkstraFrom<std::string, int, std::hash<std::string>, HeapQueue<std::string, int>, SearchStats>(
+        std::string("s"), 0, [&](auto& search, const std::string& u, int d) {
+            for (const auto& [v, weight] : weighted[u]) {
+                search.Look(v, d + weight);
+            }
+        });
+    assert(reports.size() == 3);
+    assert(reports[2].visits == 5);
+    assert(reports[2].pushes == 11 && reports[2].pops == 11);
+    assert(reports[2].stale_pops == 6);
+
+    // Many insertions into the visited map make it rehash.
+    BFSFrom<int, std::hash<int>, SearchStats>(0, [](auto& search, int x) {
+        if (x < 1000) {
+            search.Look(x + 1);
+        }
+    });
+    assert(reports.size() == 4 && reports[3].rehashes > 0);
+    std::ostringstream oss;
+    oss << reports[3];
+    assert(oss.str().starts_with("BFS: 1001 visits"));
+
+    // DFS keeps two maps, and each rehashes on its own. Count the bucket
+    // changes of a plain map with the same insertions.
+    DFSFrom<int, std::hash<int>, SearchStats>(0, [](auto& search, int x) {
+        if (x < 1000) {
+            search.Look(x + 1);
+        }
+    });
+    std::unordered_map<int, int> mirror;
+    long long expected = 0;
+    size_t buckets = 0;
+    for (int x = 0; x <= 1000; x++) {
+        mirror[x] = x;
+        if (mirror.bucket_count() != buckets) {
+            expected += (buckets != 0);
+            buckets = mirror.bucket_count();
+        }
+    }
+    assert(reports.size() == 5 && reports[4].rehashes == 2 * expected);
+
+    SearchStats::reporter = saved_reporter;
+    static_assert(sizeof(NoSearchStats) == 1);
+}
+
+void TestPhaseProfiler() {
+    PhaseProfiler profiler;
+    for (int i = 0; i < 3; i++) {
+        ScopedTimer parse("parse", profiler);
+    }
+    {
+        ScopedTimer search("search", profiler);
+        for (int i = 0; i < 5; i++) {
+            ScopedTimer expand("expand", profiler);
+            volatile long long sum = 0;
+            for (int k = 0; k < 100000; k++) {
+                sum = sum + k;
+            }
+        }
+        ScopedTimer parse("parse", profiler);
+    }
+
+    std::vector<PhaseProfiler::Phase> phases = profiler.Phases();
+    assert(phases.size() == 4);
+    std::vector<std::tuple<std::string, int, long long>> shape;
+    for (const auto& phase : phases) {
+        shape.emplace_back(phase.path, phase.depth, phase.calls);
+        assert(phase.ms >= 0 && phase.self_ms >= 0 && phase.self_ms <= phase.ms);
+    }
+    assert((shape == std::vector<std::tuple<std::string, int, long long>>{
+                         {"parse", 1, 3}, {"search", 1, 1}, {"search/expand", 2, 5},
+                         {"search/parse", 2, 1}}));
+    assert(phases[2].ms + phases[3].ms <= phases[1].ms);
+    assert(phases[1].ms <= profiler.TotalMs());
+    assert(phases[2].ms > 0);
+
+    std::ostringstream json;
+    profiler.WriteJson(json);
+    std::vector<std::string> lines = Split(Trim(json.str()), "\n");
+    assert(lines.size() == 6);
+    assert(lines[0].starts_with("{\"total_ms\": "));
+    assert(lines[3].starts_with("{\"path\": \"search/expand\", \"depth\": 2, \"ms\": "));
+    assert(lines[3].ends_with(", \"calls\": 5},"));
+    assert(lines[5] == "]}");
+
+    std::ostringstream report;
+    profiler.Report(report);
+    assert(Split(Trim(report.str()), "\n").size() == 6);
+}
+
+void TestPerfCounters() {
+    PerfCounters counters;
+    PerfSample before = counters.Read();
+    volatile long long sum = 0;
+    for (int k = 0; k < 1000000; k++) {
+        sum = sum + k;
+    }
+    PerfSample region = counters.Read() - before;
+    for (int k = 0; k < kNumPerfEvents; k++) {
+        PerfEvent event = PerfEvent(k);
+        // Counters may be missing (e.g. in a virtual machine), but never
+        // show up out of nowhere.
+        assert(region.Get(event).has_value() <= counters.Available(event));
+        assert(PerfSample().Get(event) == std::nullopt);
+    }
+    if (counters.Available(PerfEvent::kInstructions)) {
+        assert(*region.Get(PerfEvent::kInstructions) >= 1000000);
+    }
+
+    // Profiles come out the same with or without counters.
+    PhaseProfiler profiler;
+    assert(profiler.EnablePerfCounters() == counters.Available());
+    {
+        ScopedTimer timer("work", profiler);
+        sum = sum + 1;
+    }
+    assert(profiler.Phases().size() == 1);
+    assert(profiler.Phases()[0].perf.Get(PerfEvent::kCycles).has_value() ==
+           counters.Available(PerfEvent::kCycles));
+}
+
+struct CachedPoint {
+    int x;
+    long long y;
+    char tag;
+
+    bool operator==(const CachedPoint&) const = default;
+};
+
+void TestParseCache() {
+    // Round trips through BinaryWriter and BinaryReader.
+    using Value = std::tuple<std::vector<CachedPoint>, std::vector<std::vector<int>>,
+                             std::vector<std::string>, std::map<std::string, std::vector<std::string>>,
+                             std::unordered_map<int, std::pair<std::string, Coord>>, std::string>;
+    Value value = {{{1, -2, 'a'}, {3, 1LL << 40, 'b'}},
+                   {{1, 2, 3}, {}, {4}},
+                   {"", "abc", "de"},
+                   {{"jqt", {"rhn", "xhk"}}, {"x", {}}},
+                   {{7, {"seven", Coord(1, 2)}}, {-1, {"", Coord(0, 0)}}},
+                   "tail"};
+    BinaryWriter out;
+    Serializer<Value>::Write(out, value);
+    std::vector<uint64_t> aligned((out.Bytes().size() + 7) / 8);
+    std::memcpy(aligned.data(), out.Bytes().data(), out.Bytes().size());
+    BinaryReader in(reinterpret_cast<const std::byte*>(aligned.data()), out.Bytes().size());
+    Value copy;
+    Serializer<Value>::Read(in, copy);
+    assert(!in.Failed() && in.AtEnd());
+    assert(copy == value);
+
+    // Truncated data fails instead of reading past the end.
+    for (size_t size : {size_t(0), size_t(7), out.Bytes().size() / 2, out.Bytes().size() - 1}) {
+        BinaryReader truncated(reinterpret_cast<const std::byte*>(aligned.data()), size);
+        Value partial;
+        Serializer<Value>::Read(truncated, partial);
+        assert(truncated.Failed());
+    }
+
+    // The cache is used until the input or the version changes.
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "aoc_parse_cache_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::string input = (dir / "input.txt").string();
+    std::ofstream(input) << "1 2 3\n4 5\n";
+    int parses = 0;
+    auto parse = [&](const std::string& contents) {
+        parses++;
+        std::vector<std::vector<int>> result;
+        for (const std::string& line : Split(Trim(contents), "\n")) {
+            result.push_back(ParseVector<int>(line));
+        }
+        return result;
+    };
+    using Rows = std::vector<std::vector<int>>;
+    Rows expected = {{1, 2, 3}, {4, 5}};
+    assert(CachedParse<Rows>(input, "rows", 1, parse) == expected);
+    assert(CachedParse<Rows>(input, "rows", 1, parse) == expected);
+    assert(parses == 1);
+    assert(std::filesystem::exists(input + ".rows.cache"));
+    CachedParse<Rows>(input, "rows", 2, parse);
+    assert(parses == 2);
+
+    std::ofstream(input) << "1 2 3\n4 6\n";
+    assert(CachedParse<Rows>(input, "rows", 2, parse) == (Rows{{1, 2, 3}, {4, 6}}));
+    assert(parses == 3);
+
+    // A damaged cache file is replaced.
+    std::filesystem::resize_file(input + ".rows.cache", 40);
+    assert(CachedParse<Rows>(input, "rows", 2, parse) == (Rows{{1, 2, 3}, {4, 6}}));
+    assert(parses == 4);
+    CachedParse<Rows>(input, "rows", 2, parse);
+    assert(parses == 4);
+    // No temporary files are left behind.
+    assert(std::distance(std::filesystem::directory_iterator(dir),
+                         std::filesystem::directory_iterator()) == 2);
+    std::filesystem::remove_all(dir);
+
+    static_assert(Blittable<CachedPoint> && Blittable<Coord>);
+    static_assert(!Blittable<const char*> && !Blittable<std::string_view>);
+    static_assert(!Blittable<std::span<const int>> && !Blittable<int* [3]>);
+}
+
+void TestMonotonicArena() {
+    for (bool huge_pages : {false, true}) {
+        MonotonicArena arena(256, huge_pages);
+        size_t reserved = 0;
+        for (int round = 0; round < 3; round++) {
+            arena.Reset();
+            assert(arena.BytesUsed() == 0);
+            std::vector<void*> blocks;
+            for (int k = 1; k <= 200; k++) {
+                size_t alignment = size_t(1) << (k % 5);
+                void* p = arena.allocate(k, alignment);
+                assert((uintptr_t)p % alignment == 0);
+                std::memset(p, k, k);
+                blocks.push_back(p);
+            }
+            for (int k = 1; k <= 200; k++) {
+                assert(((unsigned char*)blocks[k - 1])[k - 1] == (unsigned char)k);
+            }
+            assert(arena.BytesUsed() >= 200 * 201 / 2);
+            // After the first round, Reset() merges the chunks into one that
+            // fits the whole round, so no more memory is needed.
+            if (round == 2) {
+                assert(arena.BytesReserved() == reserved);
+            }
+            reserved = arena.BytesReserved();
+        }
+
+        // Alignments beyond what operator new gives the chunks.
+        for (size_t alignment : {32, 64, 4096}) {
+            // A byte to move the cursor off any alignment.
+            std::memset(arena.allocate(1, 1), 0, 1);
+            void* p = arena.allocate(alignment, alignment);
+            assert((uintptr_t)p % alignment == 0);
+            std::memset(p, 0, alignment);
+        }
+    }
+
+    // Searches keep their maps in the arena and give the same results.
+    auto visit = [](auto& search, int x) {
+        for (int y : {2 * x % 1000, (x + 7) % 1000}) {
+            search.Look(y);
+        }
+    };
+    MonotonicArena arena;
+    for (int round = 0; round < 2; round++) {
+        arena.Reset();
+        std::pmr::polymorphic_allocator<int> alloc(&arena);
+        BFSResult<int, std::hash<int>, std::pmr::polymorphic_allocator<int>> depths =
+            BFSFrom(1, visit, alloc);
+        assert(depths.get_allocator().resource() == &arena);
+        BFSResult<int> expected = BFSFrom(1, visit);
+        assert(depths.size() == expected.size());
+        for (const auto& [x, d] : expected) {
+            assert(depths.at(x) == d);
+        }
+        assert(arena.BytesUsed() > 0);
+
+        auto times = DFSFrom(1, visit, alloc);
+        assert(times.enter_times.size() == expected.size());
+        auto dists = DijkstraFrom(1, 0, [](auto& search, int x, int d) {
+            search.Look((x + 1) % 10, d + 1);
+        }, alloc);
+        assert(dists.size() == 10 && dists.at(0) == 9);
+    }
+}
+
 void TestManhattanSpiral() {
     NestedVector<2, int> matrix = ConstVector(-1, 7, 7);
     int count = 0;
@@ -410,6 +744,759 @@ void TestSplit() {
             std::tuple<std::vector<std::string>, std::vector<std::string>>({"a", "b"}, {"d", "e"})));
 }
 
+void TestCharGrid() {
+    CharGrid grid(std::string("abc\ndef\n\n"));
+    assert(grid.SizeI() == 2);
+    assert(grid.SizeJ() == 3);
+    assert(grid.Stride() == 4);
+    assert(grid[Coord(1, 2)] == 'f');
+    assert(grid[0] == "abc");
+    assert(grid.Text()[grid.Index({1, 0})] == 'd');
+    assert((grid.Rows() == std::vector<std::string>{"abc", "def"}));
+
+    grid[Coord(0, 1)] = 'x';
+    assert(grid[0][1] == 'x');
+
+    assert(CharGrid(std::string("")).SizeI() == 0);
+    assert(CharGrid(std::string("ab")).Bounds().size_j == 2);
+
+    Grid<uint8_t> digits = CharGrid(std::string("12\n34\n56")).Digits();
+    assert(digits.SizeI() == 3);
+    assert(digits.SizeJ() == 2);
+    assert(digits[Coord(2, 0)] == 5);
+    assert(digits[1][1] == 4);
+    assert((digits.Data() == std::vector<uint8_t>{1, 2, 3, 4, 5, 6}));
+
+    Grid<int> ints = CharGrid(std::string("#.\n.#")).Convert([](char c) { return (c == '#') ? 1 : 0; });
+    assert((ints.Data() == std::vector<int>{1, 0, 0, 1}));
+}
+
+void TestTranspose() {
+    assert((Transpose(std::vector<std::string>{"abc", "def"}) ==
+            std::vector<std::string>{"ad", "be", "cf"}));
+    assert((Transpose(NestedVector<2, int>{{1, 2}, {3, 4}, {5, 6}}) ==
+            NestedVector<2, int>{{1, 3, 5}, {2, 4, 6}}));
+
+    // Big enough to span several tiles, with partial tiles at the edges.
+    std::vector<std::string> big(150, std::string(100, ' '));
+    for (int i = 0; i < 150; i++) {
+        for (int j = 0; j < 100; j++) {
+            big[i][j] = 'a' + (i * 7 + j * 3) % 26;
+        }
+    }
+    std::vector<std::string> big_t = Transpose(big);
+    assert(Sizes<2>(big_t) == std::make_tuple(100, 150));
+    for (int i = 0; i < 150; i++) {
+        for (int j = 0; j < 100; j++) {
+            assert(big_t[j][i] == big[i][j]);
+        }
+    }
+    assert(Transpose(big_t) == big);
+
+    TransposedView view(big);
+    assert(Sizes<2>(view) == std::make_tuple(100, 150));
+    assert(view[17][42] == big[42][17]);
+    assert(std::string(view[5].begin(), view[5].end()) == big_t[5]);
+    assert(Find<2>(TransposedView(std::vector<std::string>{"ab", "cd"}), 'b') == std::make_tuple(1, 0));
+
+    // Bit matrices: row i, bit j is set iff (i * 5 + j * 3) % 7 == 0.
+    for (auto [height, width] : {std::make_pair(1, 1), std::make_pair(64, 64),
+                                 std::make_pair(70, 130), std::make_pair(200, 3)}) {
+        auto bit = [](int i, int j) { return (i * 5 + j * 3) % 7 == 0; };
+        NestedVector<2, uint64_t> m = ConstVector<uint64_t>(0, height, (width + 63) / 64);
+        for (int i = 0; i < height; i++) {
+            for (int j = 0; j < width; j++) {
+                m[i][j / 64] |= (uint64_t)bit(i, j) << (j % 64);
+            }
+        }
+        NestedVector<2, uint64_t> t = TransposeBits(m, width);
+        assert(Sizes<2>(t) == std::make_tuple(width, (height + 63) / 64));
+        for (int j = 0; j < width; j++) {
+            for (int i = 0; i < (height + 63) / 64 * 64; i++) {
+                bool expected = i < height && bit(i, j);
+                assert(((t[j][i / 64] >> (i % 64)) & 1) == expected);
+            }
+        }
+        assert(TransposeBits(t, height) == m);
+    }
+}
+
+void TestParallelMapReduce() {
+    std::vector<long long> xs;
+    for (int i = 0; i < 10000; i++) {
+        xs.push_back(i);
+    }
+    auto square = [](long long x) { return x * x; };
+    auto sum = [](long long a, long long b) { return a + b; };
+    long long expected = 0;
+    for (long long x : xs) {
+        expected += x * x;
+    }
+    assert(ParallelMapReduce(xs, square, sum) == expected);
+
+    ThreadPool pool(4);
+    assert(pool.NumThreads() == 4);
+    assert(ParallelMapReduce(xs, square, sum, pool) == expected);
+    assert(ParallelMapReduce(std::vector<long long>{}, square, sum, pool) == 0);
+
+    // The reduction is applied in order, so non-commutative ones work.
+    std::vector<std::string> words;
+    std::string concat;
+    for (int i = 0; i < 3000; i++) {
+        words.push_back(std::to_string(i));
+        concat += std::to_string(i) + ",";
+    }
+    assert(ParallelMapReduce(
+               words, [](const std::string& s) { return s + ","; },
+               [](std::string a, const std::string& b) { return a + b; }, pool) == concat);
+}
+
+long long ParallelFib(int n, ThreadPool& pool) {
+    if (n < 2) {
+        return n;
+    }
+    long long a, b;
+    TaskGroup group(pool);
+    group.Run([&]() { a = ParallelFib(n - 1, pool); });
+    b = ParallelFib(n - 2, pool);
+    group.Wait();
+    return a + b;
+}
+
+void TestThreadPool() {
+    for (int threads : {1, 3}) {
+        ThreadPool pool(threads);
+
+        std::vector<int> hits(5000, 0);
+        ParallelFor(0, hits.size(), [&](int k) { hits[k]++; }, pool);
+        assert(std::ranges::count(hits, 1) == hits.size());
+
+        NestedVector<2, int> cells = ConstVector(0, 30, 40);
+        ParallelFor(Box(5, 10, 20, 25), [&](Coord c) { cells[c.i][c.j]++; }, pool);
+        for (Coord c : Box(30, 40)) {
+            assert(cells[c.i][c.j] == Box(5, 10, 20, 25).contains(c));
+        }
+
+        // Nested parallel loops and task groups.
+        std::atomic<int> total = 0;
+        ParallelFor(0, 20, [&](int) { ParallelFor(0, 50, [&](int) { total++; }, pool); }, pool);
+        assert(total == 1000);
+        assert(ParallelFib(20, pool) == 6765);
+
+        // An exception in a task comes out of Wait() after the other tasks
+        // have finished, and the group can be used again.
+        TaskGroup group(pool);
+        std::atomic<int> finished = 0;
+        for (int k = 0; k < 10; k++) {
+            group.Run([&finished, k]() {
+                if (k == 3) {
+                    throw std::runtime_error("task failed");
+                }
+                finished++;
+            });
+        }
+        bool thrown = false;
+        try {
+            group.Wait();
+        } catch (const std::runtime_error& e) {
+            thrown = std::string(e.what()) == "task failed";
+        }
+        assert(thrown && finished == 9);
+        group.Run([&finished]() { finished++; });
+        group.Wait();
+        assert(finished == 10);
+
+        thrown = false;
+        try {
+            ParallelFor(0, 1000, [](int k) {
+                if (k == 999) {
+                    throw std::runtime_error("");
+                }
+            }, pool);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    assert(ThreadPool::Default().NumThreads() == ThreadPool::DefaultNumThreads());
+}
+
+template <typename M>
+void TestModIntArithmetic() {
+    long long m = M::Mod();
+    for (long long a = -30; a < 30; a++) {
+        for (long long b = -30; b < 30; b++) {
+            M x = a, y = b;
+            assert(x.Val() == SafeMod(a, m));
+            assert((x + y).Val() == SafeMod(a + b, m));
+            assert((x - y).Val() == SafeMod(a - b, m));
+            assert((x * y).Val() == SafeMod(a * b, m));
+            assert((-x).Val() == SafeMod(-a, m));
+            assert((x == y) == (SafeMod(a - b, m) == 0));
+            assert((a + y).Val() == SafeMod(a + b, m));
+            if (Gcd(b, m) == 1) {
+                assert((x / y) * y == x);
+            }
+        }
+    }
+    M big = 4000000000LL, prod = 1;
+    for (int e = 0; e < 50; e++) {
+        assert(big.Pow(e) == prod);
+        prod *= big;
+    }
+}
+
+void TestChecked() {
+    using C = Checked<int>;
+    for (int a = -30; a < 30; a++) {
+        for (int b = -30; b < 30; b++) {
+            C x = a, y = b;
+            assert((x + y).Val() == a + b);
+            assert((x - y).Val() == a - b);
+            assert((x * y).Val() == a * b);
+            assert((-x).Val() == -a);
+            assert((x < y) == (a < b));
+            assert((x == y) == (a == b));
+            assert((a + y).Val() == a + b);
+            if (b != 0) {
+                assert((x / y).Val() == a / b);
+                assert((x % y).Val() == a % b);
+            }
+        }
+    }
+
+    // Right at the limits, nothing overflows yet.
+    const int max = std::numeric_limits<int>::max(), lowest = std::numeric_limits<int>::lowest();
+    assert(C(max - 1) + 1 == max);
+    assert(C(lowest + 1) - 1 == lowest);
+    assert(C(46340) * 46340 == 2147395600);
+    assert(C(lowest) / 1 == lowest);
+    assert(-C(max) - 1 == lowest);
+    assert(C(4000000000LL - 3000000000LL) == 1000000000);
+    assert(Checked<unsigned>(4000000000LL) * 1u == 4000000000u);
+
+    Checked<long long> answer = 0;
+    for (int k = 1; k <= 20; k++) {
+        answer *= 1;
+        answer += Checked<long long>(k) * 1000000000000LL;
+    }
+    assert(answer == 210000000000000LL);
+    std::ostringstream out;
+    out << answer;
+    assert(out.str() == "210000000000000");
+
+    static_assert((Checked<__int128>(1) * 1000000007 * 1000000007).Val() == (__int128)1000000014000000049LL);
+    static_assert(Checked<long long>(7) % -3 == 1);
+}
+
+void TestModInt() {
+    TestModIntArithmetic<ModInt<1000000007>>();
+    TestModIntArithmetic<ModInt<16777216>>();
+    TestModIntArithmetic<ModInt<1>>();
+
+    DynModInt<>::SetMod(998244353);
+    TestModIntArithmetic<DynModInt<>>();
+    DynModInt<>::SetMod(2147483647);
+    TestModIntArithmetic<DynModInt<>>();
+    DynModInt<1>::SetMod(12);
+    TestModIntArithmetic<DynModInt<1>>();
+    assert(DynModInt<>::Mod() == 2147483647);
+
+    // Fermat's little theorem, at compile time.
+    static_assert(ModInt<1000000007>(123456789).Pow(1000000006) == 1);
+    static_assert(ModInt<7>(-1).Val() == 6);
+    static_assert((3 * ModInt<7>(5)).Val() == 1);
+    assert(Inverse(ModInt<1000000007>(2)) == 500000004);
+    assert(ModInt<1000000007>(2).Inv().Val() == Inverse(2LL, 1000000007LL));
+
+    std::vector<ModInt<101>> xs, expected;
+    for (int i = 1; i < 101; i++) {
+        xs.push_back(i);
+        expected.push_back(ModInt<101>(i).Inv());
+    }
+    BatchInverse(xs);
+    assert(xs == expected);
+
+    // Barrett reduction against plain division near the top of the range.
+    Barrett barrett(2147483629);
+    for (uint32_t a = 2147483628; a > 2147000000; a -= 9973) {
+        for (uint32_t b = 1; b < 2147483629; b = b * 3 + 1) {
+            assert(barrett.Mul(a, b) == (uint64_t)a * b % 2147483629);
+        }
+    }
+}
+
+void TestBigInt() {
+    // Small values against __int128, including ones that overflow it.
+    const __int128 max = ~(unsigned __int128)0 >> 1;
+    std::vector<__int128> values = {0, 1, -1, 7, -7, 1000000007, -(__int128)1 << 64, max, -max - 1};
+    for (__int128 a : values) {
+        for (__int128 b : values) {
+            BigInt x = a, y = b;
+            assert((x == y) == (a == b));
+            assert((x <=> y) == (a <=> b));
+            assert(x + y - y == x);
+            assert(x - y + y == x);
+            __int128 c;
+            if (!__builtin_add_overflow(a, b, &c)) {
+                assert(x + y == c);
+            } else {
+                assert(!(x + y).IsSmall());
+            }
+            if (a == (long long)a && b == (long long)b) {
+                assert(x * y == a * b);
+            }
+            if (b != 0) {
+                assert(x * y / y == x);
+            }
+            if (b != 0) {
+                BigInt q = x / y, r = x % y;
+                assert(q * y + r == x);
+                if (!(a == -max - 1 && b == -1)) {
+                    assert(q == a / b);
+                    assert(r == a % b);
+                }
+            }
+        }
+    }
+    assert(-BigInt(-max - 1) == BigInt(max) + 1);
+    assert((-BigInt(-max - 1) - 1).IsSmall());
+
+    // Big values, with Karatsuba kicking in for the products.
+    BigInt a = 1, b = 1;
+    for (int i = 0; i < 3000; i++) {
+        a *= 3;
+    }
+    for (int i = 0; i < 1999; i++) {
+        b *= -7;
+    }
+    BigInt p = a * b;
+    assert(p / a == b);
+    assert(p / b == a);
+    assert(p % a == 0);
+    assert((p - 12345) % b == -12345);
+    assert((-p + 12345) % a == 12345);
+    assert((p - 1) / a == b);
+    assert((p + 1) / a == b + 1);
+    BigInt q = (a + 11) / (b - 5), r = (a + 11) % (b - 5);
+    assert(q * (b - 5) + r == a + 11);
+    assert(r > 0 && r < -(b - 5));
+    assert((a - b) * (a + b) == a * a - b * b);
+    assert(Gcd(a * 35, b * 6) == 21);
+    assert(Gcd(a, b) == 1);
+
+    // Printing and parsing.
+    BigInt f = 1;
+    for (int i = 1; i <= 30; i++) {
+        f *= i;
+    }
+    assert(f.ToString() == "265252859812191058636308480000000");
+    assert(BigInt(f.ToString()) == f);
+    assert((-(f * f)).ToString() == "-70359079638545882374689246780656119576032161719910400000000000000");
+    assert(BigInt(a.ToString()) == a);
+    assert(BigInt((-b).ToString()) == -b);
+    assert(BigInt("-000123") == -123);
+    assert(BigInt("+170141183460469231731687303715884105728").ToString() ==
+           "170141183460469231731687303715884105728");
+    assert((ParseVector<BigInt>("1, -2 100000000000000000000000000000000000000000") ==
+            std::vector<BigInt>{1, -2, BigInt("100000000000000000000000000000000000000000")}));
+    std::ostringstream oss;
+    oss << BigInt(0) << " " << BigInt(-42) << " " << (BigRat)f / (BigRat)(-(f * 7));
+    assert(oss.str() == "0 -42 -1/7");
+
+    // Conversions.
+    assert((long long)BigInt(-5) == -5);
+    assert((long long)((BigInt(max) + 1) * 4 + 3) == 3);
+    assert((long long)(-(BigInt(max) + 1) * 4 - 3) == -3);
+    assert(std::abs((double)(f * f) / 7.0359079638545882e64 - 1) < 1e-15);
+
+    // Rationals with huge numerators and denominators.
+    BigRat x = 0;
+    for (int i = 1; i <= 200; i++) {
+        x += BigRat(1) / i;
+    }
+    assert(x.Num() == BigInt("73430450139366304745412892037069099001170161275640475032430988199840965762047744114895233"));
+    assert(x.Denom() == BigInt("12492355141960232023683917288697829904903495658709527193661000811749408076321384817296000"));
+    assert(floor(x) == 5);
+}
+
+void TestCRT() {
+    // Against brute force, including moduli with common factors.
+    for (int m1 = 1; m1 <= 12; m1++) {
+        for (int m2 = 1; m2 <= 12; m2++) {
+            for (int a1 = -3; a1 < m1; a1++) {
+                for (int a2 = 0; a2 < m2; a2++) {
+                    std::optional<int> expected;
+                    for (int x = 0; x < m1 * m2 && !expected.has_value(); x++) {
+                        if (SafeMod(x - a1, m1) == 0 && (x - a2) % m2 == 0) {
+                            expected = x;
+                        }
+                    }
+                    auto solution = SolveCRT(a1, m1, a2, m2);
+                    assert(solution.has_value() == expected.has_value());
+                    if (solution.has_value()) {
+                        assert(solution->first == *expected);
+                        assert(solution->second == Lcm(m1, m2));
+                    }
+                }
+            }
+        }
+    }
+
+    // The lcm barely fits into long long, the intermediate products don't.
+    auto big = SolveCRT(5661348892LL, 5999999622LL, 4230143704LL, 5999999574LL);
+    assert(big == std::make_pair(4321098765432109876LL, 5999999196000026838LL));
+    assert(SolveCRT(1LL, 5999999622LL, 0LL, 5999999574LL) == std::nullopt);
+
+    assert((SolveCRT(std::vector<std::pair<int, int>>{{2, 3}, {3, 5}, {2, 7}}) == std::make_pair(23, 105)));
+    assert((SolveCRT(std::vector<std::pair<int, int>>{{1, 4}, {0, 6}}) == std::nullopt));
+    assert((SolveCRT(std::vector<std::pair<int, int>>{}) == std::make_pair(0, 1)));
+
+    // Hits at 2, 5, 8, ... and at 10, 14, 15, 19, 20, ...
+    assert((CombineCycles<long long>({{2, 3, {0}}, {10, 5, {0, 4}}}) == 14));
+    // Hits at 31, 34, 37, ... instead.
+    assert((CombineCycles<long long>({{31, 3, {0}}, {10, 5, {0, 4}}}) == 34));
+    // Always even and always odd.
+    assert((CombineCycles<long long>({{0, 2, {0}}, {0, 4, {1, 3}}}) == std::nullopt));
+    assert((CombineCycles<long long>({{0, 3847, {3846}}, {0, 4001, {4000}}, {0, 3877, {3876}}, {0, 3823, {3822}}}) ==
+            3847LL * 4001 * 3877 * 3823 - 1));
+}
+
+template <typename T>
+void TestLinearAlgebra() {
+    Matrix<T> a = {{2, 1, -1}, {-3, -1, 2}, {-2, 1, 2}};
+    assert(Rank(a) == 3);
+    assert(IsZeroEntry(Determinant(a) - T(-1)));
+    std::optional<std::vector<T>> x = SolveLinear(a, std::vector<T>{8, -11, -3});
+    assert(x.has_value());
+    std::vector<T> expected = {2, 3, -1};
+    for (int i = 0; i < 3; i++) {
+        assert(IsZeroEntry((*x)[i] - expected[i]));
+    }
+    assert(a * Matrix<T>::Identity(3) == a);
+
+    // The third row is the sum of the first two.
+    Matrix<T> b = {{1, 2, 3, 4}, {0, 1, 1, 2}, {1, 3, 4, 6}};
+    assert(Rank(b) == 2);
+    std::vector<std::vector<T>> basis = NullSpace(b);
+    assert(basis.size() == 2);
+    for (const std::vector<T>& v : basis) {
+        for (const T& y : b * v) {
+            assert(IsZeroEntry(y));
+        }
+    }
+    assert(!SolveLinear(b, std::vector<T>{1, 1, 1}).has_value());
+    x = SolveLinear(b, std::vector<T>{1, 1, 2});
+    assert(x.has_value());
+    std::vector<T> bx = b * *x;
+    assert(IsZeroEntry(bx[0] - T(1)) && IsZeroEntry(bx[1] - T(1)) && IsZeroEntry(bx[2] - T(2)));
+
+    Matrix<T> swapped = {{0, 1}, {1, 0}};
+    assert(IsZeroEntry(Determinant(swapped) - T(-1)));
+    assert(IsZeroEntry(Determinant(Matrix<T>{{1, 2}, {2, 4}})));
+    assert(Rank(Matrix<T>(2, 3)) == 0);
+}
+
+void TestLinearSystemBatch() {
+    // Systems {x + s * y == 2s + 1, s * x + y == 3}, some singular.
+    LinearSystemBatch<2, long long> batch(5);
+    for (int s = 0; s < batch.Size(); s++) {
+        batch.A(s, 0, 0) = 1;
+        batch.A(s, 0, 1) = s;
+        batch.A(s, 1, 0) = s;
+        batch.A(s, 1, 1) = 1;
+        batch.B(s, 0) = 2 * s + 1;
+        batch.B(s, 1) = 3;
+    }
+    batch.Solve();
+    for (int s = 0; s < batch.Size(); s++) {
+        assert(batch.Det(s) == 1 - s * s);
+        if (batch.Det(s) != 0) {
+            long long x = batch.Numerator(s, 0), y = batch.Numerator(s, 1), d = batch.Det(s);
+            assert(x + s * y == (2 * s + 1) * d);
+            assert(s * x + y == 3 * d);
+        }
+    }
+
+    // Against the general determinant.
+    LinearSystemBatch<4, LLRat> big(1);
+    Matrix<LLRat> m(4, 4);
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            big.A(0, i, j) = m[i][j] = (i * 7 + j * j * 3) % 11 - 5;
+        }
+        big.B(0, i) = i;
+    }
+    big.Solve();
+    assert(big.Det(0) == Determinant(m));
+    auto x = SolveLinear(m, std::vector<LLRat>{0, 1, 2, 3});
+    for (int k = 0; k < 4; k++) {
+        assert(big.Numerator(0, k) / big.Det(0) == (*x)[k]);
+    }
+
+    // Many 3 x 3 determinants at once, against one at a time.
+    std::array<std::vector<long long>, 9> columns;
+    for (int e = 0; e < 9; e++) {
+        for (int s = 0; s < 20; s++) {
+            columns[e].push_back((e * 5 + s * s * 3 + e * s) % 13 - 6);
+        }
+    }
+    std::array<const long long*, 9> entries;
+    for (int e = 0; e < 9; e++) {
+        entries[e] = columns[e].data();
+    }
+    std::vector<long long> dets(20);
+    SmallDeterminants<3, long long>(entries, 20, dets.data());
+    for (int s = 0; s < 20; s++) {
+        std::array<long long, 9> single;
+        for (int e = 0; e < 9; e++) {
+            single[e] = columns[e][s];
+        }
+        assert((dets[s] == SmallDeterminant<3, long long>(single)));
+    }
+}
+
+void TestTransitionSystem() {
+    // Fibonacci's rabbits: a young pair grows up, an adult one gives birth.
+    auto rabbits = [](auto& t, int adult) {
+        t.Add(1);
+        if (adult) {
+            t.Add(0);
+        }
+    };
+    TransitionSystem<int> ll(std::vector<int>{0}, rabbits);
+    assert(ll.NumStates() == 2);
+    assert(ll.NumTransitions() == 3);
+    std::vector<long long> counts = ll.Counts(std::vector<int>{0});
+    long long f0 = 0, f1 = 1;
+    for (int n = 1; n <= 90; n++) {
+        counts = ll.Step(counts);
+        std::tie(f0, f1) = std::make_pair(f1, f0 + f1);
+        assert(counts[ll.Id(1)] == f0);
+        assert(counts[ll.Id(0)] == f1 - f0);
+        assert(ll.Advance(ll.Counts(std::vector<int>{0}), n) == counts);
+    }
+
+    using Mod = ModInt<1000000007>;
+    TransitionSystem<int, Mod> mod(std::vector<int>{0}, rabbits);
+    std::vector<Mod> big = mod.Advance(mod.Counts(std::vector<int>{0}), 1000000000000000000LL);
+    assert(big[mod.Id(1)] == 209783453);
+    assert(big[mod.Id(0)] == 470273943);
+
+    // Many states, few steps: every number splits in halves.
+    TransitionSystem<int> halves(std::vector<int>{1000}, [](auto& t, int x) {
+        t.Add(x / 2);
+        t.Add(x - x / 2);
+    });
+    assert(halves.GetState(0) == 1000);
+    std::vector<long long> split = halves.Advance(halves.Counts(std::vector<int>{1000}), 20);
+    long long total = 0, sum = 0;
+    for (int id = 0; id < halves.NumStates(); id++) {
+        total += split[id];
+        sum += split[id] * halves.GetState(id);
+    }
+    assert(total == 1 << 20);
+    assert(sum == 1000);
+}
+
+void TestSequenceModel() {
+    // A cubic, evaluated far away and at negative indices.
+    auto cubic = [](long long n) { return 2 * n * n * n - 3 * n + 7; };
+    std::vector<long long> terms;
+    for (int n = 0; n < 6; n++) {
+        terms.push_back(cubic(n));
+    }
+    auto model = SequenceModel<long long>::Fit(terms);
+    assert(model.has_value() && model->IsPolynomial());
+    assert(model->Size() == 4);
+    for (long long n : {-5LL, -1LL, 0LL, 5LL, 100LL, 1000000LL}) {
+        assert(model->At(n) == cubic(n));
+    }
+    assert(SequenceModel<long long>::Fit({0, 1, 4, 9})->At(1000) == 1000000);
+    assert(SequenceModel<long long>::Fit({5, 5})->At(-7) == 5);
+    assert(SequenceModel<long long>::Fit({0, 0})->Size() == 0);
+    // Too few terms to tell the degree.
+    assert(!SequenceModel<long long>::FitPolynomial({0, 1, 4}).has_value());
+    assert(!SequenceModel<long long>::FitPolynomial({}).has_value());
+    assert(!SequenceModel<long long>::Fit({1, 2, 4, 8, 16, 32}).has_value());
+
+    assert(SequenceModel<LLRat>::Fit({(LLRat)1 / 2, 1, (LLRat)3 / 2})->At(9) == 5);
+
+    // Powers of two are not a polynomial, but a recurrence of length 1.
+    auto powers = SequenceModel<LLRat>::Fit({1, 2, 4, 8, 16, 32});
+    assert(powers.has_value() && !powers->IsPolynomial());
+    assert(powers->Coefficients() == std::vector<LLRat>{2});
+    assert(powers->At(40) == 1LL << 40);
+
+    // Fibonacci numbers modulo a prime.
+    using Mod = ModInt<1000000007>;
+    auto fib = SequenceModel<Mod>::FitRecurrence({0, 1, 1, 2, 3, 5, 8});
+    assert(fib.has_value());
+    assert((fib->Coefficients() == std::vector<Mod>{1, 1}));
+    assert(fib->At(1000000000000000000LL) == 209783453);
+    assert(!SequenceModel<Mod>::FitRecurrence({0, 1, 1}).has_value());
+
+    // 2^n + 3^n - n has a recurrence of length 4.
+    std::vector<Mod> mixed;
+    for (int n = 0; n < 8; n++) {
+        mixed.push_back(Mod(2).Pow(n) + Mod(3).Pow(n) - n);
+    }
+    auto mixed_model = SequenceModel<Mod>::Fit(mixed);
+    assert(mixed_model.has_value() && mixed_model->Size() == 4);
+    assert(mixed_model->At(1000000000000000000LL) == 965812894);
+    for (int n = 0; n < 8; n++) {
+        assert(mixed_model->At(n) == mixed[n]);
+    }
+}
+
+void TestIntervalSet() {
+    using Set = IntervalSet<int>;
+    auto to_bits = [](const Set& set) {
+        std::vector<bool> bits(64, false);
+        for (const auto& [begin, end] : set) {
+            assert(begin < end);
+            for (int x = begin; x < end; x++) {
+                bits[x] = true;
+            }
+        }
+        return bits;
+    };
+
+    // Random operations against a vector of bools.
+    unsigned seed = 12345;
+    auto random = [&seed](int bound) {
+        seed = seed * 1103515245 + 12345;
+        return (int)((seed >> 16) % bound);
+    };
+    for (int round = 0; round < 200; round++) {
+        Set a, b;
+        std::vector<bool> bits_a(64, false), bits_b(64, false);
+        std::vector<std::pair<int, int>> raw;
+        for (int k = 0; k < 8; k++) {
+            int begin = random(64), end = random(65);
+            bool erase = random(3) == 0;
+            if (erase) {
+                a.Erase(begin, end);
+            } else {
+                a.Insert(begin, end);
+            }
+            for (int x = begin; x < end; x++) {
+                bits_a[x] = !erase;
+            }
+
+            begin = random(64);
+            end = std::min(64, begin + random(10));
+            raw.emplace_back(begin, end);
+            for (int x = begin; x < end; x++) {
+                bits_b[x] = true;
+            }
+        }
+        b = Set(raw);
+        assert(to_bits(a) == bits_a);
+        assert(to_bits(b) == bits_b);
+        // Merged intervals are neither adjacent nor overlapping.
+        for (const auto& [begin, end] : a.Gaps()) {
+            assert(begin < end);
+        }
+
+        std::vector<bool> both(64), either(64), only_a(64), not_a(64);
+        int length = 0;
+        for (int x = 0; x < 64; x++) {
+            both[x] = bits_a[x] && bits_b[x];
+            either[x] = bits_a[x] || bits_b[x];
+            only_a[x] = bits_a[x] && !bits_b[x];
+            not_a[x] = !bits_a[x] && x >= 10 && x < 50;
+            length += bits_a[x];
+            assert(a.Contains(x) == bits_a[x]);
+        }
+        assert(to_bits(a & b) == both);
+        assert(to_bits(a | b) == either);
+        assert(to_bits(a - b) == only_a);
+        assert(to_bits(a.Complement(10, 50)) == not_a);
+        assert(a.TotalLength() == length);
+        assert((a | b) == (b | a));
+        Set c = a;
+        c -= b;
+        c |= a & b;
+        assert(c == a);
+    }
+
+    Set s = {{10, 20}, {0, 5}, {5, 7}, {30, 30}};
+    assert((s.Intervals() == std::vector<std::pair<int, int>>{{0, 7}, {10, 20}}));
+    assert((s.Gaps() == std::vector<std::pair<int, int>>{{7, 10}}));
+    s.Insert(7, 10);
+    assert(s.NumIntervals() == 1 && s.TotalLength() == 20);
+    s.Erase(3, 4);
+    assert((s == Set{{0, 3}, {4, 20}}));
+    assert(Set().Complement(-5, 5) == Set({{-5, 5}}));
+    assert((IntervalSet<long long>{{0, 1LL << 40}}.TotalLength() == 1LL << 40));
+}
+
+void TestPiecewiseAffineMap() {
+    using Map = PiecewiseAffineMap<int>;
+    unsigned seed = 4321;
+    auto random = [&seed](int bound) {
+        seed = seed * 1103515245 + 12345;
+        return (int)((seed >> 16) % bound);
+    };
+    // Maps of [0, 100) onto itself, as lists of disjoint shifted ranges.
+    auto random_map = [&]() {
+        std::vector<std::tuple<int, int, int>> ranges;
+        for (int begin = random(10); begin < 100; begin += random(10)) {
+            int end = std::min(100, begin + 1 + random(15));
+            int shift = random(100) - begin;
+            ranges.emplace_back(begin, std::min(end, 100 - shift), shift);
+            begin = end;
+        }
+        return ranges;
+    };
+    auto brute_force = [](const std::vector<std::tuple<int, int, int>>& ranges, int x) {
+        for (const auto& [begin, end, shift] : ranges) {
+            if (x >= begin && x < end) {
+                return x + shift;
+            }
+        }
+        return x;
+    };
+
+    for (int round = 0; round < 200; round++) {
+        auto ranges_f = random_map(), ranges_g = random_map();
+        Map f(ranges_f), g(ranges_g);
+        Map h = Compose(g, f);
+        for (int k = 0; k + 1 < (int)h.Pieces().size(); k++) {
+            assert(h.Pieces()[k].first < h.Pieces()[k + 1].first);
+            assert(h.Pieces()[k].second != h.Pieces()[k + 1].second);
+        }
+
+        IntervalSet<int> set;
+        for (int k = 0; k < 3; k++) {
+            int begin = random(110) - 5;
+            set.Insert(begin, begin + random(20));
+        }
+        std::vector<std::pair<int, int>> image;
+        std::optional<int> min_image;
+        for (int x = -10; x < 130; x++) {
+            int y = brute_force(ranges_g, brute_force(ranges_f, x));
+            assert(f(x) == brute_force(ranges_f, x));
+            assert(h(x) == y);
+            if (set.Contains(x)) {
+                image.emplace_back(y, y + 1);
+                min_image = min_image.has_value() ? std::min(*min_image, y) : y;
+            }
+        }
+        assert(h.Apply(set) == IntervalSet<int>(image));
+        assert(h.MinImage(set) == min_image);
+    }
+
+    Map m = Map::Parse({"seed-to-soil map:", "50 98 2", "52 50 48"});
+    assert(m(0) == 0 && m(49) == 49 && m(50) == 52 && m(97) == 99 && m(98) == 50 && m(100) == 100);
+    assert((m.Apply(IntervalSet<int>{{95, 101}}) == IntervalSet<int>{{50, 52}, {97, 101}}));
+    assert(m.MinImage(60, 100) == 50);
+    assert(m.MinImage(5, 5) == std::nullopt);
+    assert(Compose(Map(), Map()) == Map());
+    assert(Compose(m, Map()) == m && Compose(Map(), m) == m);
+}
+
 int main() {
     std::cerr << "Testing Split()..." << std::endl;
     TestSplit();
@@ -455,6 +1542,69 @@ int main() {
 
     std::cerr << "Testing GetPrimes()..." << std::endl;
     assert((GetPrimes(20) == std::vector<int>{2, 3, 5, 7, 11, 13, 17, 19}));
+    for (int bound = 0; bound < 2000; bound++) {
+        std::vector<int> expected;
+        for (int i = 2; i < bound; i++) {
+            if (std::ranges::none_of(expected, [i](int p) { return i % p == 0; })) {
+                expected.push_back(i);
+            }
+        }
+        assert(GetPrimes(bound) == expected);
+    }
+    {
+        // Spans many segments, and checks there are no gaps between them.
+        long long count = 0, last = 0;
+        ForEachPrime(100000000LL, [&](long long p) {
+            assert(p > last);
+            count++;
+            last = p;
+        });
+        assert(count == 5761455);
+        assert(last == 99999989);
+    }
+
+    std::cerr << "Testing SmallestFactorTable..." << std::endl;
+    {
+        SmallestFactorTable table(100000);
+        assert(table.Primes() == GetPrimes(100000));
+        for (int x = 2; x < 100000; x++) {
+            int p = table.SmallestFactor(x);
+            assert(x % p == 0);
+            assert(table.IsPrime(p));
+            assert(table.IsPrime(x) == (p == x));
+            for (int q = 2; q * q <= p; q++) {
+                assert(x % q != 0);
+            }
+        }
+        assert(!table.IsPrime(0));
+        assert(!table.IsPrime(1));
+        assert(table.Factorize(1).empty());
+        assert((table.Factorize(2 * 2 * 2 * 3 * 7 * 7) ==
+                std::vector<std::pair<int, int>>{{2, 3}, {3, 1}, {7, 2}}));
+        assert((table.Factorize(99991) == std::vector<std::pair<int, int>>{{99991, 1}}));
+    }
+
+    std::cerr << "Testing ModInt..." << std::endl;
+    TestModInt();
+
+    std::cerr << "Testing Checked..." << std::endl;
+    TestChecked();
+
+    std::cerr << "Testing SolveCRT() and CombineCycles()..." << std::endl;
+    TestCRT();
+
+    std::cerr << "Testing linear algebra..." << std::endl;
+    TestLinearAlgebra<LLRat>();
+    TestLinearAlgebra<ModInt<1000000007>>();
+    TestLinearAlgebra<double>();
+    TestLinearAlgebra<BigRat>();
+    TestLinearSystemBatch();
+
+    std::cerr << "Testing TransitionSystem..." << std::endl;
+    TestTransitionSystem();
+
+    std::cerr << "Testing SequenceModel..." << std::endl;
+    TestSequenceModel();
 
     std::cerr << "Testing rounding divisions..." << std::endl;
     for (int i = -24; i <= 24; i++) {
@@ -470,10 +1620,63 @@ int main() {
     TestRational<Rat, long long, double>("Rat", "long long", "double");
     TestRational<LLRat, int, double>("LLRat", "int", "double");
 
+    TestRational<I128Rat, long long, long double>("I128Rat", "long long", "long double");
+    TestRational<Rational<int, true>, int, double>("lazy Rat", "int", "double");
+    TestRational<Rational<long long, true>, long long, double>("lazy LLRat", "long long", "double");
+
+    std::cerr << "Testing Rational overflow resistance..." << std::endl;
+    {
+        // Cross products of these overflow long long, but the results fit.
+        const long long x = 300000000000000000LL, y = 200000000000000000LL;
+        LLRat a = (LLRat)x / 997, b = (LLRat)y / 997;
+        assert(a + b == (LLRat)(x + y) / 997);
+        assert(a - b == (LLRat)(x - y) / 997);
+        assert(a / b == (LLRat)3 / 2);
+        assert(a * ((LLRat)997 / x) == 1);
+        assert(a * (b / y) == (LLRat)x / (997 * 997));
+        assert(a > b);
+        assert(b < a);
+        assert((LLRat)x / 991 > a);
+
+        const long long big = 300000000000000LL;
+        Rational<long long, true> c = big, d = (Rational<long long, true>)1 / 3;
+        for (int i = 0; i < 100; i++) {
+            c = c * 3 * d;
+        }
+        assert(c == big);
+        assert(c.Num() == big);
+        assert(c.Denom() == 1);
+        assert((c / 4).Denom() == 1);
+    }
+
+    TestRational<BigRat, long long, long double>("BigRat", "long long", "long double");
+
+    std::cerr << "Testing BigInt..." << std::endl;
+    TestBigInt();
+
+    std::cerr << "Testing __int128 printing..." << std::endl;
+    {
+        std::ostringstream oss;
+        __int128 x = (__int128)1000000000000000000LL * 1000000000000000000LL;
+        oss << x << " " << -x << " " << (__int128)0 << " " << (I128Rat)x / 3;
+        assert(oss.str() == "1000000000000000000000000000000000000 -1000000000000000000000000000000000000 "
+                            "0 1000000000000000000000000000000000000/3");
+        oss.str("");
+        __int128 max = ~(unsigned __int128)0 >> 1;
+        oss << max << " " << -max - 1;
+        assert(oss.str() == "170141183460469231731687303715884105727 -170141183460469231731687303715884105728");
+    }
+
     std::cerr << "Testing Rational conversions..." << std::endl;
     assert((LLRat)((Rat)2 / 3) == (LLRat)2 / 3);
     assert((Rat)((LLRat)2 / 3) == (Rat)2 / 3);
 
+    std::cerr << "Testing IntervalSet..." << std::endl;
+    TestIntervalSet();
+
+    std::cerr << "Testing PiecewiseAffineMap..." << std::endl;
+    TestPiecewiseAffineMap();
+
     std::cerr << "Testing NTuple..." << std::endl;
     static_assert(std::is_same_v<NTuple<0, int>, std::tuple<>>);
     static_assert(std::is_same_v<NTuple<1, int>, std::tuple<int>>);
@@ -484,6 +1687,35 @@ int main() {
     assert(Find<2>(std::vector<std::string>{"abcdef", "gijklmnop"}, 'l') == std::make_tuple(1, 4));
     assert(Find<2>(std::vector<std::string>{"abcdef", "gijklmnop"}, 'z') == std::nullopt);
     assert(FindOrDie<2>(std::vector<std::string>{"abcdef", "gijklmnop"}, 'd') == std::make_tuple(0, 3));
+    assert(Find<2>(NestedVector<2, int>{{1, 2}, {3, 4}}, 4) == std::make_tuple(1, 1));
+    assert(Find<3>(NestedVector<3, char>{{{'a'}, {'b'}}, {{'c', 'd'}}}, 'd') == std::make_tuple(1, 0, 1));
+    assert(Find<1>(std::string("xyz"), 'y') == std::make_tuple(1));
+    assert(Find<1>(std::string(""), 'y') == std::nullopt);
+
+    std::cerr << "Testing Count() and FindAll()..." << std::endl;
+    {
+        std::vector<std::string> grid = {"#..#", "....", ".##."};
+        assert(Count<2>(grid, '#') == 4);
+        assert(Count<2>(grid, 'x') == 0);
+        assert(Count<2>(NestedVector<2, int>{{1, 2}, {2, 2}}, 2) == 3);
+        assert((FindAll<2>(grid, '#') ==
+                std::vector<NTuple<2, int>>{{0, 0}, {0, 3}, {2, 1}, {2, 2}}));
+        assert(FindAll<2>(grid, 'x').empty());
+        assert((FindCoords(grid, '#') == std::vector<Coord>{{0, 0}, {0, 3}, {2, 1}, {2, 2}}));
+
+        CharGrid char_grid(std::string("#..#\n....\n.##.\n"));
+        assert(Find<2>(char_grid, '#') == std::make_tuple(0, 0));
+        assert(FindOrDie<2>(char_grid, '#') == std::make_tuple(0, 0));
+        assert(Find<2>(char_grid, 'x') == std::nullopt);
+        assert(Count<2>(char_grid, '#') == 4);
+        assert(FindAll<2>(char_grid, '#') == FindAll<2>(grid, '#'));
+        assert(FindCoords(char_grid, '.') == FindCoords(grid, '.'));
+
+        std::string long_row(1000, '.');
+        long_row[3] = long_row[500] = long_row[999] = '#';
+        assert(Count<1>(long_row, '#') == 3);
+        assert((FindAll<1>(long_row, '#') == std::vector<NTuple<1, int>>{{3}, {500}, {999}}));
+    }
 
     std::cerr << "Testing NestedVector..." << std::endl;
     static_assert(std::is_same_v<NestedVector<0, int>, int>);
@@ -496,12 +1728,30 @@ int main() {
     assert((ConstVector(42, 2, 3) == NestedVector<2, int>{{42, 42, 42}, {42, 42, 42}}));
     assert(Sizes<3>(ConstVector('x', 3, 4, 5)) == std::make_tuple(3, 4, 5));
 
+    std::cerr << "Testing Transpose()..." << std::endl;
+    TestTranspose();
+
     std::cerr << "Testing DFS()..." << std::endl;
     TestDFS();
 
     std::cerr << "Testing Dijkstra()..." << std::endl;
     TestDijkstra();
 
+    std::cerr << "Testing SearchStats..." << std::endl;
+    TestSearchStats();
+
+    std::cerr << "Testing MonotonicArena..." << std::endl;
+    TestMonotonicArena();
+
+    std::cerr << "Testing PhaseProfiler..." << std::endl;
+    TestPhaseProfiler();
+
+    std::cerr << "Testing PerfCounters..." << std::endl;
+    TestPerfCounters();
+
+    std::cerr << "Testing CachedParse()..." << std::endl;
+    TestParseCache();
+
     std::cerr << "Testing PathCO and PathCC..." << std::endl;
     assert((std::ranges::equal(PathCO({1, 2}, {1, 2}), std::vector<Coord>{})));
     assert((std::ranges::equal(PathCO({1, 2}, {3, 4}), std::vector<Coord>{{1, 2}, {2, 3}})));
@@ -526,6 +1776,15 @@ int main() {
     assert((std::ranges::equal(ChessCircle({5, 5}, 1), std::vector<Coord>{
                                                            {6, 6}, {5, 6}, {4, 6}, {4, 5}, {4, 4}, {5, 4}, {6, 4}, {6, 5}})));
 
+    std::cerr << "Testing CharGrid and Grid..." << std::endl;
+    TestCharGrid();
+
+    std::cerr << "Testing ParallelMapReduce()..." << std::endl;
+    TestParallelMapReduce();
+
+    std::cerr << "Testing ThreadPool, TaskGroup and ParallelFor()..." << std::endl;
+    TestThreadPool();
+
     std::cerr << "OK" << std::endl;
     return 0;
 }
\ No newline at end of file